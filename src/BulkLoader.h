@@ -0,0 +1,145 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef RCPERF_BULKLOADER_H
+#define RCPERF_BULKLOADER_H
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Cycles.h"
+#include "MultiWrite.h"
+#include "RamCloud.h"
+#include "Tub.h"
+
+using namespace RAMCloud;
+
+/**
+ * Loads experiment datasets into RAMCloud with batched, pipelined
+ * multiWrites instead of one synchronous write per object. Up to
+ * pipelineDepth MultiWrite RPCs of batchSize objects each are kept in
+ * flight. Experiments lay out their keys so that consecutive keys land on
+ * consecutive tablets, so every batch spreads evenly over all of the
+ * table's servers.
+ */
+class BulkLoader {
+  PUBLIC:
+    /**
+     * \param client
+     *      RamCloud instance to write through.
+     * \param batchSize
+     *      Number of objects in each multiWrite.
+     * \param pipelineDepth
+     *      Maximum number of multiWrites in flight at once.
+     */
+    BulkLoader(RamCloud* client, uint32_t batchSize, uint32_t pipelineDepth)
+      : client(client),
+        batchSize(batchSize),
+        pipelineDepth(pipelineDepth),
+        lastLoadSeconds(0.0) {
+    }
+
+    /**
+     * Write count objects that all have the same value. Prints the load
+     * throughput when done.
+     *
+     * \param tableId
+     *      Table to write the objects into.
+     * \param keys
+     *      count keys of keySize bytes each, stored back to back.
+     * \param keySize
+     *      Size of each key in bytes.
+     * \param count
+     *      Number of objects to write.
+     * \param value
+     *      Value written into every object.
+     * \param valueSize
+     *      Size of the value in bytes.
+     */
+    void load(uint64_t tableId, const char* keys, uint16_t keySize,
+        uint32_t count, const char* value, uint32_t valueSize) {
+      std::vector<Tub<MultiWrite>> rpcs(pipelineDepth);
+      std::vector<MultiWriteObject> objects((uint64_t)pipelineDepth * batchSize);
+      std::vector<MultiWriteObject*> requests((uint64_t)pipelineDepth * batchSize);
+      std::vector<uint32_t> batchCounts(pipelineDepth);
+
+      uint64_t start = Cycles::rdtsc();
+      uint32_t next = 0;
+      uint32_t outstanding = 0;
+      while (next < count || outstanding > 0) {
+        for (uint32_t slot = 0; slot < pipelineDepth; slot++) {
+          if (rpcs[slot]) {
+            if (!rpcs[slot]->isReady())
+              continue;
+
+            rpcs[slot]->wait();
+            rpcs[slot].destroy();
+            outstanding--;
+
+            MultiWriteObject** batch = &requests[(uint64_t)slot * batchSize];
+            for (uint32_t i = 0; i < batchCounts[slot]; i++) {
+              if (batch[i]->status != STATUS_OK) {
+                printf("ERROR: Bulk load write failed: %s\n",
+                    statusToString(batch[i]->status));
+              }
+            }
+          }
+
+          if (next < count) {
+            uint32_t n = std::min(batchSize, count - next);
+            MultiWriteObject** batch = &requests[(uint64_t)slot * batchSize];
+            for (uint32_t i = 0; i < n; i++) {
+              MultiWriteObject* object = &objects[(uint64_t)slot * batchSize + i];
+              *object = MultiWriteObject(tableId,
+                  keys + (uint64_t)(next + i) * keySize, keySize,
+                  value, valueSize);
+              batch[i] = object;
+            }
+
+            batchCounts[slot] = n;
+            rpcs[slot].construct(client, batch, n);
+            outstanding++;
+            next += n;
+          }
+        }
+
+        client->poll();
+      }
+      uint64_t end = Cycles::rdtsc();
+
+      lastLoadSeconds = Cycles::toSeconds(end - start);
+      double megabytes = (double)count * (keySize + valueSize) / 1e6;
+      printf("Bulk load: %d objects, %.1f MB in %.3f s (%.0f objs/s, %.1f MB/s, batch_size: %d, pipeline_depth: %d)\n",
+          count, megabytes, lastLoadSeconds, count / lastLoadSeconds,
+          megabytes / lastLoadSeconds, batchSize, pipelineDepth);
+    }
+
+    /**
+     * Return how long the most recent load() took, in seconds.
+     */
+    double getLastLoadSeconds() {
+      return lastLoadSeconds;
+    }
+
+  PRIVATE:
+    RamCloud* client;
+    uint32_t batchSize;
+    uint32_t pipelineDepth;
+    double lastLoadSeconds;
+};
+
+#endif // RCPERF_BULKLOADER_H
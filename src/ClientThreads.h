@@ -0,0 +1,149 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef RCPERF_CLIENTTHREADS_H
+#define RCPERF_CLIENTTHREADS_H
+
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include "Cycles.h"
+#include "RamCloud.h"
+
+using namespace RAMCloud;
+
+/**
+ * Runs the same measurement body on a group of client threads, each with its
+ * own RamCloud instance, and measures the interval during which all of them
+ * were issuing operations. Used for closed-loop throughput measurements.
+ *
+ * The body is called as body(RamCloud* client, uint32_t threadIndex). It
+ * should do its per-thread setup first, then call start(), issue its
+ * operations, and call stop(). start() is a barrier, so no thread begins
+ * measuring before every thread has finished its setup.
+ *
+ * With a single thread the body runs on the calling thread using the
+ * caller's RamCloud instance, so single-threaded measurements behave exactly
+ * as they did before throughput mode existed.
+ */
+class ClientThreads {
+  PUBLIC:
+    /**
+     * \param client
+     *      RamCloud instance of the calling thread. Used directly when
+     *      numThreads is 1.
+     * \param options
+     *      Options used to construct a RamCloud instance for each thread when
+     *      numThreads is greater than 1.
+     * \param numThreads
+     *      Number of client threads to run the body on.
+     */
+    ClientThreads(RamCloud* client, CommandLineOptions* options,
+        uint32_t numThreads)
+      : numThreads(numThreads),
+        client(client),
+        options(options),
+        readyCount(0),
+        go(false),
+        failed(false),
+        startTime(0),
+        stopTime(0) {
+    }
+
+    template<typename F>
+    void run(F body) {
+      readyCount = 0;
+      go = false;
+      failed = false;
+      startTime = 0;
+      stopTime = 0;
+
+      if (numThreads == 1) {
+        body(client, 0);
+        return;
+      }
+
+      std::vector<std::thread> threads;
+      std::vector<std::exception_ptr> errors(numThreads);
+      for (uint32_t t = 0; t < numThreads; t++) {
+        threads.emplace_back([this, &body, &errors, t]() {
+          try {
+            RamCloud threadClient(options);
+            body(&threadClient, t);
+          } catch (...) {
+            errors[t] = std::current_exception();
+            failed = true;
+          }
+        });
+      }
+
+      for (uint32_t t = 0; t < numThreads; t++)
+        threads[t].join();
+
+      for (uint32_t t = 0; t < numThreads; t++) {
+        if (errors[t])
+          std::rethrow_exception(errors[t]);
+      }
+    }
+
+    /**
+     * Wait until every thread in the group has called start(). The last
+     * thread to arrive records the start of the measurement interval.
+     */
+    void start() {
+      if (readyCount.fetch_add(1) + 1 == numThreads) {
+        startTime = Cycles::rdtsc();
+        go = true;
+      }
+
+      while (!go && !failed) {
+        // Spin; threads are about to issue RPCs anyway.
+      }
+    }
+
+    /**
+     * Record that the calling thread has finished issuing operations. The
+     * measurement interval ends when the last thread calls stop().
+     */
+    void stop() {
+      uint64_t now = Cycles::rdtsc();
+      uint64_t prev = stopTime;
+      while (prev < now && !stopTime.compare_exchange_weak(prev, now)) {
+      }
+    }
+
+    /**
+     * Return the length of the measurement interval of the last run(), from
+     * the moment every thread was ready to the moment the last one stopped.
+     */
+    double getElapsedSeconds() {
+      return Cycles::toSeconds(stopTime - startTime);
+    }
+
+    const uint32_t numThreads;
+
+  PRIVATE:
+    RamCloud* client;
+    CommandLineOptions* options;
+    std::atomic<uint32_t> readyCount;
+    std::atomic<bool> go;
+    std::atomic<bool> failed;
+    std::atomic<uint64_t> startTime;
+    std::atomic<uint64_t> stopTime;
+};
+
+#endif // RCPERF_CLIENTTHREADS_H
@@ -0,0 +1,220 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef RCPERF_DATASETPLANNER_H
+#define RCPERF_DATASETPLANNER_H
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "RamCloud.h"
+
+#include "BulkLoader.h"
+
+using namespace RAMCloud;
+
+/**
+ * Keeps track of which datasets are resident in RAMCloud, so that read-only
+ * experiments load each dataset once and serve every point that needs only
+ * part of it from what is already there.
+ *
+ * The planner owns one table, created with the server span of the current
+ * point and kept across points and sections until a different span is
+ * needed. For each key size it records the value size and the number of
+ * objects last loaded into the table. Because a KeySet of n keys is always
+ * a prefix of a larger KeySet for the same table and key size, a point that
+ * needs count objects of a resident value size only loads the objects past
+ * the resident count, if any.
+ *
+ * The order*() methods reorder a section's sweep so that it starts with the
+ * server span and value sizes that are already resident.
+ */
+class DatasetPlanner {
+  PUBLIC:
+    /**
+     * \param client
+     *      RamCloud instance used to create and drop the planner's table.
+     */
+    explicit DatasetPlanner(RamCloud* client)
+      : client(client),
+        tableName("dataset"),
+        tableId(0),
+        serverSize(0),
+        resident(),
+        loadedObjects(0),
+        loadedBytes(0),
+        loadSeconds(0.0),
+        reusedObjects(0),
+        reusedBytes(0) {
+    }
+
+    ~DatasetPlanner() {
+      if (serverSize != 0)
+        client->dropTable(tableName);
+    }
+
+    /**
+     * Return the planner's table, spread over serverSize servers. If the
+     * resident table has a different span, or there is none yet, any table
+     * of that name is dropped, along with all of its datasets, and a new one
+     * is created.
+     */
+    uint64_t getTable(uint32_t serverSize) {
+      if (serverSize == this->serverSize)
+        return tableId;
+
+      // Before the first table this drops any table left by a run that
+      // crashed, whose span may differ (dropping a missing table does
+      // nothing).
+      client->dropTable(tableName);
+      resident.clear();
+      tableId = client->createTable(tableName, serverSize);
+      this->serverSize = serverSize;
+      return tableId;
+    }
+
+    /**
+     * Make sure the first count keys of keys hold objects with valueSize
+     * byte values, loading only the objects that are not already resident.
+     *
+     * \param loader
+     *      Loader to write missing objects with.
+     * \param keys
+     *      Keys from a KeySet for the planner's current table, keySize bytes
+     *      each, stored back to back.
+     * \param keySize
+     *      Size of each key in bytes.
+     * \param count
+     *      Number of objects the point needs.
+     * \param value
+     *      Value to write into missing objects.
+     * \param valueSize
+     *      Size of the value in bytes.
+     */
+    void load(BulkLoader* loader, const char* keys, uint16_t keySize,
+        uint32_t count, const char* value, uint32_t valueSize) {
+      Dataset& dataset = resident[keySize];
+      uint32_t first = 0;
+      if (dataset.valueSize == valueSize)
+        first = std::min(dataset.count, count);
+
+      reusedObjects += first;
+      reusedBytes += (uint64_t)first * (keySize + valueSize);
+      if (first == count)
+        return;
+
+      loader->load(tableId, keys + (uint64_t)first * keySize, keySize,
+          count - first, value, valueSize);
+      loadedObjects += count - first;
+      loadedBytes += (uint64_t)(count - first) * (keySize + valueSize);
+      loadSeconds += loader->getLastLoadSeconds();
+
+      // Any objects past count keep the old value size, so they no longer
+      // count as resident when the value size changes.
+      if (dataset.valueSize == valueSize)
+        dataset.count = std::max(dataset.count, count);
+      else
+        dataset.count = count;
+      dataset.valueSize = valueSize;
+    }
+
+    /**
+     * Return true if the first count objects for keySize are resident with
+     * valueSize byte values.
+     */
+    bool isResident(uint16_t keySize, uint32_t valueSize,
+        uint32_t count = 1) const {
+      std::map<uint16_t, Dataset>::const_iterator it = resident.find(keySize);
+      return it != resident.end() && it->second.valueSize == valueSize &&
+          it->second.count >= count;
+    }
+
+    /**
+     * Return serverSizes with the span of the resident table moved to the
+     * front, so a section can start with the table left by the previous one.
+     */
+    std::vector<uint32_t> orderServerSizes(
+        const std::vector<uint32_t>& serverSizes) const {
+      std::vector<uint32_t> ordered(serverSizes);
+      std::stable_partition(ordered.begin(), ordered.end(),
+          [this](uint32_t s) { return s == serverSize; });
+      return ordered;
+    }
+
+    /**
+     * Return valueSizes with the value size resident for keySize moved to
+     * the front.
+     */
+    std::vector<uint32_t> orderValueSizes(uint16_t keySize,
+        const std::vector<uint32_t>& valueSizes) const {
+      std::vector<uint32_t> ordered(valueSizes);
+      std::stable_partition(ordered.begin(), ordered.end(),
+          [this, keySize](uint32_t v) { return isResident(keySize, v); });
+      return ordered;
+    }
+
+    /**
+     * Print how much data was loaded and reused since the last call, with
+     * an estimate of the load time saved by reuse, and reset the counts.
+     */
+    void printSummary(const char* name) {
+      double saved = 0.0;
+      if (loadedBytes > 0)
+        saved = loadSeconds * reusedBytes / loadedBytes;
+      printf("Dataset planner (%s): loaded %lu objects (%.1f MB) in %.3f s, reused %lu resident objects (%.1f MB, ~%.3f s of loading saved)\n",
+          name, loadedObjects, loadedBytes / 1e6, loadSeconds,
+          reusedObjects, reusedBytes / 1e6, saved);
+
+      loadedObjects = 0;
+      loadedBytes = 0;
+      loadSeconds = 0.0;
+      reusedObjects = 0;
+      reusedBytes = 0;
+    }
+
+  PRIVATE:
+    /// Objects resident for one key size.
+    struct Dataset {
+      Dataset() : valueSize(0), count(0) {}
+
+      uint32_t valueSize;
+
+      /// The first count keys of the key set hold objects of valueSize.
+      uint32_t count;
+    };
+
+    RamCloud* client;
+    const char* tableName;
+
+    /// The planner's table and its span, or 0 if there is no table yet.
+    uint64_t tableId;
+    uint32_t serverSize;
+
+    std::map<uint16_t, Dataset> resident;
+
+    /// Counts since the last printSummary().
+    uint64_t loadedObjects;
+    uint64_t loadedBytes;
+    double loadSeconds;
+    uint64_t reusedObjects;
+    uint64_t reusedBytes;
+
+    DISALLOW_COPY_AND_ASSIGN(DatasetPlanner);
+};
+
+#endif // RCPERF_DATASETPLANNER_H
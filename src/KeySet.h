@@ -0,0 +1,278 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef RCPERF_KEYSET_H
+#define RCPERF_KEYSET_H
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Cycles.h"
+#include "Exception.h"
+#include "Key.h"
+
+using namespace RAMCloud;
+
+/**
+ * A set of keys for a table spread evenly over serverSize tablets, such that
+ * key n lives on tablet (n % serverSize). Keys are the decimal strings of
+ * candidate numbers, NUL padded to keySize bytes. keySize must hold the
+ * digits of every candidate used, or an Exception is thrown.
+ *
+ * The tablet of a candidate is computed directly from its hash (tablets
+ * evenly divide the hash space, as createTable() lays them out), and every
+ * candidate is kept for whichever tablet it hashes to, so only about count
+ * candidates are hashed in total. Hashing is spread over all cores.
+ *
+ * Generated sets can be cached in a directory, one file per (tableId,
+ * serverSize, keySize, count), and are memory-mapped from there on later
+ * runs. Key hashes depend on the table id, so a cached set is only reused
+ * for a table with the same id (e.g. on a freshly started cluster).
+ */
+class KeySet {
+  PUBLIC:
+    /**
+     * \param tableId
+     *      Table the keys are for.
+     * \param serverSize
+     *      Number of tablets the table was created with.
+     * \param keySize
+     *      Size of each key in bytes.
+     * \param count
+     *      Number of keys.
+     * \param cacheDir
+     *      Directory for cached key sets. Empty disables caching.
+     */
+    KeySet(uint64_t tableId, uint32_t serverSize, uint16_t keySize,
+        uint32_t count, const std::string& cacheDir = "")
+      : keySize(keySize),
+        count(count),
+        keys(NULL),
+        mapped(NULL),
+        mappedSize(0),
+        heapKeys() {
+      // Candidates 0 to count - 1 are needed at least.
+      if (count > 0)
+        checkKeySize(count - 1);
+
+      char path[1024] = "";
+      if (cacheDir.size() > 0) {
+        snprintf(path, sizeof(path), "%s/keys.t_%lu.ss_%u.ks_%u.n_%u",
+            cacheDir.c_str(), tableId, serverSize, keySize, count);
+        if (map(path))
+          return;
+      }
+
+      uint64_t start = Cycles::rdtsc();
+      generate(tableId, serverSize);
+      printf("Generated %d keys (key_size: %dB, server_size: %d) in %.3f s\n",
+          count, keySize, serverSize,
+          Cycles::toSeconds(Cycles::rdtsc() - start));
+
+      if (cacheDir.size() > 0)
+        save(cacheDir, path);
+    }
+
+    ~KeySet() {
+      if (mapped != NULL)
+        munmap(mapped, mappedSize);
+    }
+
+    /**
+     * Return all of the keys, keySize bytes each, stored back to back.
+     */
+    const char* getKeys() const {
+      return keys;
+    }
+
+    /**
+     * Return key i.
+     */
+    const char* getKey(uint32_t i) const {
+      return keys + (uint64_t)i * keySize;
+    }
+
+    uint32_t getCount() const {
+      return count;
+    }
+
+  PRIVATE:
+    /**
+     * Fill heapKeys with a freshly generated key set.
+     */
+    void generate(uint64_t tableId, uint32_t serverSize) {
+      uint64_t tabletRange = 1 + ~0UL / serverSize;
+      uint32_t perTablet = (count + serverSize - 1) / serverSize;
+      std::vector<std::vector<uint32_t>> tablets(serverSize);
+
+      uint32_t numThreads = std::max(1U, std::thread::hardware_concurrency());
+      uint64_t nextCandidate = 0;
+      uint32_t missing = perTablet * serverSize;
+      while (missing > 0) {
+        // Hash the next round of candidates in parallel. Each thread takes a
+        // contiguous range and buckets its candidates by tablet, so merging
+        // in thread order keeps every tablet's candidates sorted.
+        uint64_t roundSize = std::max<uint64_t>(missing + missing / 8, 4096);
+        uint64_t perThread = (roundSize + numThreads - 1) / numThreads;
+        std::vector<std::vector<std::vector<uint32_t>>> found(numThreads,
+            std::vector<std::vector<uint32_t>>(serverSize));
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < numThreads; t++) {
+          uint64_t first = nextCandidate + t * perThread;
+          threads.emplace_back([&, t, first]() {
+            std::vector<char> key(keySize);
+            for (uint64_t c = first; c < first + perThread; c++) {
+              format(c, &key[0]);
+              uint64_t keyHash = Key::getHash(tableId, &key[0], keySize);
+              uint64_t tablet = (tabletRange == 0) ? 0 : keyHash / tabletRange;
+              found[t][std::min<uint64_t>(tablet, serverSize - 1)].push_back(c);
+            }
+          });
+        }
+        for (uint32_t t = 0; t < numThreads; t++)
+          threads[t].join();
+        nextCandidate += perThread * numThreads;
+
+        missing = 0;
+        for (uint32_t s = 0; s < serverSize; s++) {
+          for (uint32_t t = 0; t < numThreads; t++) {
+            std::vector<uint32_t>& from = found[t][s];
+            size_t take = std::min<size_t>(from.size(),
+                perTablet - tablets[s].size());
+            tablets[s].insert(tablets[s].end(), from.begin(),
+                from.begin() + take);
+          }
+          missing += perTablet - tablets[s].size();
+        }
+      }
+
+      if (count == 0)
+        return;
+
+      uint64_t largest = 0;
+      for (uint32_t s = 0; s < serverSize; s++)
+        largest = std::max<uint64_t>(largest, tablets[s].back());
+      checkKeySize(largest);
+
+      heapKeys.resize((uint64_t)count * keySize);
+      for (uint32_t n = 0; n < count; n++) {
+        format(tablets[n % serverSize][n / serverSize],
+            &heapKeys[(uint64_t)n * keySize]);
+      }
+      keys = &heapKeys[0];
+    }
+
+    /**
+     * Make sure keySize holds every digit of candidate, so that no two
+     * candidates up to it share a key.
+     */
+    void checkKeySize(uint64_t candidate) const {
+      char digits[24];
+      int length = snprintf(digits, sizeof(digits), "%lu", candidate);
+      if (length > keySize) {
+        printf("ERROR: key_size %dB is too small for %d keys, which need up to %d bytes\n",
+            keySize, count, length);
+        throw Exception(HERE, "key_size too small for the key set");
+      }
+    }
+
+    /**
+     * Write the decimal string of candidate into a zeroed key of keySize
+     * bytes.
+     */
+    void format(uint64_t candidate, char* key) const {
+      char digits[24];
+      int length = snprintf(digits, sizeof(digits), "%lu", candidate);
+      memset(key, 0, keySize);
+      memcpy(key, digits, std::min<int>(length, keySize));
+    }
+
+    /**
+     * Memory-map a cached key set. Returns false if there is no usable cache
+     * file at path.
+     */
+    bool map(const char* path) {
+      int fd = open(path, O_RDONLY);
+      if (fd < 0)
+        return false;
+
+      struct stat st;
+      size_t expected = (uint64_t)count * keySize;
+      if (fstat(fd, &st) != 0 || (size_t)st.st_size != expected ||
+          expected == 0) {
+        close(fd);
+        return false;
+      }
+
+      void* addr = mmap(NULL, expected, PROT_READ, MAP_PRIVATE | MAP_POPULATE,
+          fd, 0);
+      close(fd);
+      if (addr == MAP_FAILED)
+        return false;
+
+      mapped = addr;
+      mappedSize = expected;
+      keys = static_cast<const char*>(addr);
+      printf("Loaded %d cached keys from %s\n", count, path);
+      return true;
+    }
+
+    /**
+     * Write the generated key set to the cache. The file is written under a
+     * temporary name and renamed into place, so concurrent or interrupted
+     * runs never see a partial file.
+     */
+    void save(const std::string& cacheDir, const char* path) {
+      mkdir(cacheDir.c_str(), 0755);
+
+      std::string tmpPath = std::string(path) + ".tmp";
+      FILE* file = fopen(tmpPath.c_str(), "w");
+      if (file == NULL) {
+        printf("WARNING: Could not write key cache file %s\n", tmpPath.c_str());
+        return;
+      }
+
+      size_t size = (uint64_t)count * keySize;
+      bool ok = (fwrite(keys, 1, size, file) == size);
+      ok = (fclose(file) == 0) && ok;
+      if (!ok || rename(tmpPath.c_str(), path) != 0) {
+        printf("WARNING: Could not write key cache file %s\n", path);
+        unlink(tmpPath.c_str());
+      }
+    }
+
+    uint16_t keySize;
+    uint32_t count;
+
+    /// Points into either mapped or heapKeys.
+    const char* keys;
+
+    void* mapped;
+    size_t mappedSize;
+    std::vector<char> heapKeys;
+
+    DISALLOW_COPY_AND_ASSIGN(KeySet);
+};
+
+#endif // RCPERF_KEYSET_H
@@ -0,0 +1,290 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef RCPERF_LATENCYHISTOGRAM_H
+#define RCPERF_LATENCYHISTOGRAM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * A fixed-size, log-bucketed histogram of latency samples in the style of
+ * HdrHistogram. Values are recorded in O(1) time into buckets whose width
+ * grows with the magnitude of the value, so every recorded value is kept to
+ * within a configurable number of significant decimal digits no matter how
+ * many samples are taken. Memory use depends only on the precision and the
+ * largest trackable value, never on the number of samples.
+ *
+ * Histograms with the same configuration can be merged, which is how
+ * per-thread recorders are combined at the end of a point.
+ *
+ * The layout follows HdrHistogram: values below subBucketCount are stored
+ * exactly; above that, bucket b covers [subBucketCount << (b-1),
+ * subBucketCount << b) with subBucketCount / 2 sub-buckets each.
+ */
+class LatencyHistogram {
+  public:
+    /**
+     * \param significantDigits
+     *      Number of significant decimal digits to which each recorded value
+     *      is preserved (1 to 5).
+     * \param highestTrackableValue
+     *      Largest value that can be recorded precisely. Larger values are
+     *      counted in the highest bucket (the true maximum is still kept).
+     *      The default is one hour in nanoseconds.
+     */
+    explicit LatencyHistogram(int significantDigits = 3,
+        uint64_t highestTrackableValue = 3600UL * 1000 * 1000 * 1000)
+      : significantDigits(significantDigits),
+        subBucketHalfCountMagnitude(0),
+        subBucketHalfCount(0),
+        subBucketCount(0),
+        subBucketMask(0),
+        bucketCount(0),
+        counts(),
+        totalCount(0),
+        sum(0),
+        min(~0UL),
+        max(0) {
+      assert(significantDigits >= 1 && significantDigits <= 5);
+
+      uint64_t largestSingleUnitResolution =
+          2 * (uint64_t)pow(10, significantDigits);
+      int subBucketCountMagnitude = 0;
+      while ((1UL << subBucketCountMagnitude) < largestSingleUnitResolution)
+        subBucketCountMagnitude++;
+
+      subBucketHalfCountMagnitude = subBucketCountMagnitude - 1;
+      subBucketCount = 1UL << subBucketCountMagnitude;
+      subBucketHalfCount = subBucketCount / 2;
+      subBucketMask = subBucketCount - 1;
+
+      uint64_t smallestUntrackableValue = subBucketCount;
+      bucketCount = 1;
+      while (smallestUntrackableValue <= highestTrackableValue) {
+        if (smallestUntrackableValue > (~0UL >> 1)) {
+          bucketCount++;
+          break;
+        }
+        smallestUntrackableValue <<= 1;
+        bucketCount++;
+      }
+
+      counts.resize((bucketCount + 1) * subBucketHalfCount, 0);
+    }
+
+    /**
+     * Record one sample.
+     */
+    void record(uint64_t value) {
+      uint32_t index = countsIndexFor(value);
+      if (index >= counts.size())
+        index = counts.size() - 1;
+      counts[index]++;
+      totalCount++;
+      sum += value;
+      if (value < min)
+        min = value;
+      if (value > max)
+        max = value;
+    }
+
+    /**
+     * Add all of the samples recorded in another histogram to this one. Both
+     * histograms must have been constructed with the same arguments.
+     */
+    void merge(const LatencyHistogram& other) {
+      assert(other.counts.size() == counts.size());
+      for (size_t i = 0; i < counts.size(); i++)
+        counts[i] += other.counts[i];
+      totalCount += other.totalCount;
+      sum += other.sum;
+      if (other.min < min)
+        min = other.min;
+      if (other.max > max)
+        max = other.max;
+    }
+
+    /**
+     * Discard all recorded samples.
+     */
+    void reset() {
+      std::fill(counts.begin(), counts.end(), 0);
+      totalCount = 0;
+      sum = 0;
+      min = ~0UL;
+      max = 0;
+    }
+
+    uint64_t getCount() const { return totalCount; }
+    uint64_t getMin() const { return totalCount ? min : 0; }
+    uint64_t getMax() const { return max; }
+
+    double getMean() const {
+      return totalCount ? (double)sum / (double)totalCount : 0.0;
+    }
+
+    /**
+     * Return the value at the given percentile, i.e. the smallest recorded
+     * value (to within the histogram's precision) such that at least
+     * percentile% of all samples are less than or equal to it.
+     *
+     * \param percentile
+     *      Between 0 and 100.
+     */
+    uint64_t getPercentile(double percentile) const {
+      if (totalCount == 0)
+        return 0;
+
+      uint64_t target = (uint64_t)ceil(percentile / 100.0 * totalCount);
+      if (target < 1)
+        target = 1;
+      return getValueAtRank(target);
+    }
+
+    /**
+     * Return the value of the sample with the given rank, where rank 1 is the
+     * smallest sample and rank getCount() the largest.
+     */
+    uint64_t getValueAtRank(uint64_t rank) const {
+      if (rank >= totalCount)
+        return max;
+
+      uint64_t cumulative = 0;
+      for (size_t i = 0; i < counts.size(); i++) {
+        cumulative += counts[i];
+        if (cumulative >= rank) {
+          uint64_t value = highestEquivalentValue(valueFromIndex(i));
+          if (value > max)
+            value = max;
+          if (value < min)
+            value = min;
+          return value;
+        }
+      }
+      return max;
+    }
+
+    /**
+     * Print the column headers of printPercentiles(), each preceded by a
+     * space, with no trailing newline.
+     *
+     * \param file
+     *      File to print to.
+     * \param prefix
+     *      Prepended to each column name, for files that report more than
+     *      one histogram per row.
+     */
+    static void printHeader(FILE* file, const char* prefix = "") {
+      for (int i = 0; i < NUM_REPORTED_PERCENTILES; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "%s%s", prefix, percentileNames()[i]);
+        fprintf(file, " %12s", name);
+      }
+      char name[32];
+      snprintf(name, sizeof(name), "%sMax", prefix);
+      fprintf(file, " %12s", name);
+    }
+
+    /**
+     * Print the standard set of percentiles followed by the maximum, each
+     * preceded by a space, with no trailing newline.
+     *
+     * \param file
+     *      File to print to.
+     * \param divisor
+     *      Every value is divided by this before printing. 1000.0 turns
+     *      nanoseconds into microseconds.
+     * \param precision
+     *      Number of digits to print after the decimal point.
+     */
+    void printPercentiles(FILE* file, double divisor = 1000.0,
+        int precision = 1) const {
+      for (int i = 0; i < NUM_REPORTED_PERCENTILES; i++) {
+        fprintf(file, " %12.*f", precision,
+            getPercentile(reportedPercentiles()[i]) / divisor);
+      }
+      fprintf(file, " %12.*f", precision, getMax() / divisor);
+    }
+
+  private:
+    static const int NUM_REPORTED_PERCENTILES = 13;
+
+    static const double* reportedPercentiles() {
+      static const double percentiles[NUM_REPORTED_PERCENTILES] =
+          {1, 2, 5, 10, 25, 50, 75, 90, 95, 98, 99, 99.9, 99.99};
+      return percentiles;
+    }
+
+    static const char* const* percentileNames() {
+      static const char* const names[NUM_REPORTED_PERCENTILES] =
+          {"1th", "2th", "5th", "10th", "25th", "50th", "75th", "90th",
+           "95th", "98th", "99th", "99.9th", "99.99th"};
+      return names;
+    }
+
+    uint32_t countsIndexFor(uint64_t value) const {
+      int bucketIndex = 63 - __builtin_clzl(value | subBucketMask) -
+          subBucketHalfCountMagnitude;
+      uint32_t subBucketIndex = value >> bucketIndex;
+      return ((bucketIndex + 1) << subBucketHalfCountMagnitude) +
+          (subBucketIndex - subBucketHalfCount);
+    }
+
+    /**
+     * Return the lowest value that maps to the given counts index.
+     */
+    uint64_t valueFromIndex(size_t index) const {
+      int bucketIndex = (index >> subBucketHalfCountMagnitude) - 1;
+      uint64_t subBucketIndex = (index & (subBucketHalfCount - 1)) +
+          subBucketHalfCount;
+      if (bucketIndex < 0) {
+        subBucketIndex -= subBucketHalfCount;
+        bucketIndex = 0;
+      }
+      return subBucketIndex << bucketIndex;
+    }
+
+    /**
+     * Return the highest value that maps to the same bucket as value.
+     */
+    uint64_t highestEquivalentValue(uint64_t value) const {
+      int bucketIndex = 63 - __builtin_clzl(value | subBucketMask) -
+          subBucketHalfCountMagnitude;
+      return value + (1UL << bucketIndex) - 1;
+    }
+
+    int significantDigits;
+    int subBucketHalfCountMagnitude;
+    uint64_t subBucketHalfCount;
+    uint64_t subBucketCount;
+    uint64_t subBucketMask;
+    int bucketCount;
+
+    /// Number of samples recorded in each bucket.
+    std::vector<uint64_t> counts;
+
+    uint64_t totalCount;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+};
+
+#endif // RCPERF_LATENCYHISTOGRAM_H
@@ -0,0 +1,187 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef RCPERF_OPENLOOPGENERATOR_H
+#define RCPERF_OPENLOOPGENERATOR_H
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Cycles.h"
+#include "LatencyHistogram.h"
+#include "RamCloud.h"
+#include "Tub.h"
+
+using namespace RAMCloud;
+
+/**
+ * Issues asynchronous RPCs on a fixed schedule, independent of how quickly
+ * earlier RPCs complete (open-loop load). Latency is measured from the time
+ * each request was scheduled to be sent, not from when it was actually sent,
+ * so time a request spends waiting behind slow responses is counted instead
+ * of hidden (no coordinated omission).
+ *
+ * At most maxOutstanding RPCs are in flight at once. A request whose slot
+ * isn't free at its scheduled time is sent as soon as one frees up, and is
+ * counted as late if that was more than lateThreshold after schedule.
+ * Requests that haven't completed by a deadline of twice the scheduled
+ * duration plus one second are cancelled and counted as dropped.
+ */
+class OpenLoopGenerator {
+  PUBLIC:
+    enum ArrivalMode {
+      /// Exponentially distributed inter-arrival times.
+      POISSON,
+      /// Requests evenly spaced at 1/rate.
+      FIXED
+    };
+
+    /// Summary of one run().
+    struct Result {
+      uint64_t issued;
+      uint64_t completed;
+      uint64_t late;
+      uint64_t dropped;
+      /// Completed requests per second, from the first scheduled send to the
+      /// last completion.
+      double achievedRate;
+    };
+
+    /**
+     * \param client
+     *      RamCloud instance to poll while RPCs are outstanding.
+     * \param rate
+     *      Offered load, in requests per second.
+     * \param mode
+     *      How inter-arrival times are chosen.
+     * \param maxOutstanding
+     *      Maximum number of RPCs in flight at once.
+     * \param lateThresholdNs
+     *      A request sent more than this long after its scheduled time is
+     *      counted as late.
+     */
+    OpenLoopGenerator(RamCloud* client, double rate, ArrivalMode mode,
+        uint32_t maxOutstanding, uint64_t lateThresholdNs)
+      : client(client),
+        rate(rate),
+        mode(mode),
+        maxOutstanding(maxOutstanding),
+        lateThreshold(Cycles::fromNanoseconds(lateThresholdNs)),
+        generator(0),
+        uniform(0.0, 1.0) {
+    }
+
+    /**
+     * Issue count requests on schedule and wait for them to finish.
+     *
+     * \param count
+     *      Number of requests to schedule.
+     * \param issue
+     *      Called as issue(Tub<Rpc>* slot, uint32_t slotIndex) to construct
+     *      (and thereby send) one RPC in the given slot. slotIndex is less
+     *      than maxOutstanding and identifies the slot, so callers can keep
+     *      per-slot state such as response buffers.
+     * \param latencies
+     *      The latency of each completed request, in nanoseconds measured
+     *      from its scheduled send time, is recorded here.
+     */
+    template<typename Rpc, typename Issue>
+    Result run(uint32_t count, Issue issue, LatencyHistogram* latencies) {
+      Result result = {0, 0, 0, 0, 0.0};
+
+      std::vector<Tub<Rpc>> slots(maxOutstanding);
+      std::vector<uint64_t> scheduled(maxOutstanding);
+      std::vector<uint32_t> freeSlots;
+      for (uint32_t i = 0; i < maxOutstanding; i++)
+        freeSlots.push_back(maxOutstanding - 1 - i);
+
+      uint64_t start = Cycles::rdtsc();
+      uint64_t deadline = start + Cycles::fromSeconds(2.0 * count / rate + 1.0);
+      uint64_t next = start;
+      uint64_t lastCompletion = start;
+
+      while (result.completed + result.dropped < count) {
+        uint64_t now = Cycles::rdtsc();
+
+        if (now > deadline) {
+          for (uint32_t i = 0; i < maxOutstanding; i++) {
+            if (slots[i]) {
+              slots[i]->cancel();
+              slots[i].destroy();
+              result.dropped++;
+            }
+          }
+          result.dropped += count - result.issued;
+          break;
+        }
+
+        // Send everything that is due and has a free slot.
+        while (result.issued < count && next <= now && !freeSlots.empty()) {
+          uint32_t slot = freeSlots.back();
+          freeSlots.pop_back();
+
+          if (now - next > lateThreshold)
+            result.late++;
+
+          scheduled[slot] = next;
+          issue(&slots[slot], slot);
+          result.issued++;
+          next += interarrival();
+        }
+
+        client->poll();
+
+        for (uint32_t i = 0; i < maxOutstanding; i++) {
+          if (slots[i] && slots[i]->isReady()) {
+            slots[i]->wait();
+            uint64_t end = Cycles::rdtsc();
+            slots[i].destroy();
+            freeSlots.push_back(i);
+            latencies->record(Cycles::toNanoseconds(end - scheduled[i]));
+            lastCompletion = end;
+            result.completed++;
+          }
+        }
+      }
+
+      if (lastCompletion > start)
+        result.achievedRate = (double)result.completed /
+            Cycles::toSeconds(lastCompletion - start);
+
+      return result;
+    }
+
+  PRIVATE:
+    /**
+     * Return the time to wait before the next scheduled request, in cycles.
+     */
+    uint64_t interarrival() {
+      double seconds = 1.0 / rate;
+      if (mode == POISSON)
+        seconds = -log(1.0 - uniform(generator)) / rate;
+      return Cycles::fromSeconds(seconds);
+    }
+
+    RamCloud* client;
+    double rate;
+    ArrivalMode mode;
+    uint32_t maxOutstanding;
+    uint64_t lateThreshold;
+    std::mt19937_64 generator;
+    std::uniform_real_distribution<double> uniform;
+};
+
+#endif // RCPERF_OPENLOOPGENERATOR_H
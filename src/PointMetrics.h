@@ -0,0 +1,172 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef RCPERF_POINTMETRICS_H
+#define RCPERF_POINTMETRICS_H
+
+#include <fnmatch.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ClusterMetrics.h"
+#include "RamCloud.h"
+
+#include "SweepJournal.h"
+
+using namespace RAMCloud;
+
+/**
+ * Records how the servers' metrics change over each point of a sweep, so
+ * that a slow point can be traced to what the servers were doing: how busy
+ * their dispatch and worker threads were, how much they transmitted and
+ * retransmitted, whether the log cleaner ran, and so on.
+ *
+ * begin() fetches ClusterMetrics from every server and end() fetches them
+ * again and writes the difference of every selected counter that changed to
+ * a companion of the sweep's CSV file (<name>.metrics.csv). Each row holds
+ * the point's parameter values, the counter's delta, the counter and the
+ * server, so the rows join with the sweep's results on the parameter
+ * columns. Counters are selected by shell-style patterns (see fnmatch(3)),
+ * matched ignoring case; with no patterns nothing is fetched or written.
+ *
+ * The deltas cover everything between begin() and end(), including any
+ * setup the point does between them.
+ */
+class PointMetrics {
+  PUBLIC:
+    /**
+     * \param client
+     *      RamCloud instance used to fetch metrics.
+     * \param counters
+     *      Patterns selecting the counters to record.
+     * \param journal
+     *      The sweep's journal, which names the metrics file and tells
+     *      whether to append to it.
+     * \param columns
+     *      Names of the parameter columns, matching the values passed to
+     *      end().
+     */
+    PointMetrics(RamCloud* client, const std::vector<std::string>& counters,
+        SweepJournal* journal, const std::vector<const char*>& columns)
+      : client(client),
+        counters(counters),
+        filename(journal->getCompanionFilename("metrics")),
+        journal(journal),
+        columns(columns),
+        before(),
+        file(NULL) {
+    }
+
+    ~PointMetrics() {
+      if (file != NULL)
+        fclose(file);
+    }
+
+    /**
+     * Take the snapshot a point's deltas are computed from.
+     */
+    void begin() {
+      if (counters.empty())
+        return;
+      before.load(client);
+    }
+
+    /**
+     * Take a second snapshot and write the point's deltas.
+     *
+     * \param values
+     *      The point's parameter values, in the order of the columns passed
+     *      to the constructor.
+     */
+    void end(const std::vector<uint32_t>& values) {
+      if (counters.empty())
+        return;
+
+      ClusterMetrics after(client);
+      ClusterMetrics delta = after.difference(before);
+      open();
+
+      for (ClusterMetrics::iterator server = delta.begin();
+          server != delta.end(); server++) {
+        // Metrics come in hash order; sort them so every point lists its
+        // counters the same way.
+        std::vector<std::pair<std::string, uint64_t>> selected;
+        for (ServerMetrics::iterator it = server->second.begin();
+            it != server->second.end(); it++) {
+          if (it->second != 0 && isSelected(it->first))
+            selected.push_back(std::make_pair(it->first, it->second));
+        }
+        std::sort(selected.begin(), selected.end());
+
+        for (size_t i = 0; i < selected.size(); i++) {
+          for (size_t v = 0; v < values.size(); v++)
+            fprintf(file, (v == 0) ? "%12u" : " %12u", values[v]);
+          fprintf(file, " %16lu %-40s %s\n",
+              selected[i].second,
+              selected[i].first.c_str(),
+              server->first.c_str());
+        }
+      }
+      fflush(file);
+    }
+
+  PRIVATE:
+    /**
+     * Open the metrics file the first time it is needed, once the sweep's
+     * header has been written.
+     */
+    void open() {
+      if (file != NULL)
+        return;
+
+      file = journal->openCompanion(filename);
+      if (ftell(file) > 0)
+        return;
+      for (size_t i = 0; i < columns.size(); i++)
+        fprintf(file, (i == 0) ? "%12s" : " %12s", columns[i]);
+      fprintf(file, " %16s %-40s %s\n",
+          "Delta",
+          "Counter",
+          "Server");
+    }
+
+    bool isSelected(const std::string& name) const {
+      for (size_t i = 0; i < counters.size(); i++) {
+        if (fnmatch(counters[i].c_str(), name.c_str(), FNM_CASEFOLD) == 0)
+          return true;
+      }
+      return false;
+    }
+
+    RamCloud* client;
+    std::vector<std::string> counters;
+    std::string filename;
+    SweepJournal* journal;
+    std::vector<const char*> columns;
+
+    /// Snapshot taken by begin().
+    ClusterMetrics before;
+
+    /// Opened by the first end().
+    FILE* file;
+
+    DISALLOW_COPY_AND_ASSIGN(PointMetrics);
+};
+
+#endif // RCPERF_POINTMETRICS_H
@@ -0,0 +1,237 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef RCPERF_POINTSAMPLER_H
+#define RCPERF_POINTSAMPLER_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "Cycles.h"
+#include "LatencyHistogram.h"
+#include "TraceWriter.h"
+
+using namespace RAMCloud;
+
+/**
+ * Decides how many samples to take for one data point. A point starts with
+ * warmupSamples samples that are thrown away (they pay for cold sessions,
+ * ObjectFinder lookups and the like), followed by the measured samples.
+ *
+ * With a zero ciTarget exactly maxSamples samples are measured. Otherwise
+ * sampling stops as soon as the confidence interval of the ciPercentile'th
+ * percentile is narrower than ciTarget times the percentile itself, once at
+ * least minSamples have been measured, and in any case after maxSamples
+ * samples or maxSeconds seconds.
+ *
+ * The confidence interval comes from order statistics: the number of
+ * samples below the true percentile p is Binomial(n, p), so with normal
+ * approximation the samples at ranks n*p -/+ z*sqrt(n*p*(1-p)) bound it.
+ * Their values are read straight out of the histogram.
+ *
+ * Typical use:
+ *
+ *     PointSampler sampler(config, &hist);
+ *     while (sampler.more()) {
+ *       ...
+ *       sampler.record(latency);
+ *     }
+ */
+class PointSampler {
+  PUBLIC:
+    struct Config {
+      /// Samples taken and discarded before measuring.
+      uint32_t warmupSamples;
+      /// Measured samples to take, or the most to take in adaptive mode.
+      uint32_t maxSamples;
+      /// Target relative confidence interval width. 0 disables adaptive
+      /// mode.
+      double ciTarget;
+      /// Percentile whose confidence interval is tracked (0 to 100).
+      double ciPercentile;
+      /// Confidence level of the interval (e.g. 0.95).
+      double ciConfidence;
+      /// Fewest measured samples in adaptive mode.
+      uint32_t minSamples;
+      /// Time budget for the measured samples in adaptive mode, in seconds.
+      /// 0 means no limit.
+      double maxSeconds;
+      /// If not NULL, every measured sample is also written here, tagged
+      /// with the trace's current point.
+      TraceWriter* trace;
+    };
+
+    /**
+     * \param config
+     *      Sampling policy.
+     * \param hist
+     *      Measured samples are recorded here. It should be empty.
+     * \param onWarmedUp
+     *      Called once, right before the first measured sample. Threaded
+     *      experiments start their measurement interval here, so warmup is
+     *      not counted against throughput.
+     */
+    PointSampler(const Config& config, LatencyHistogram* hist,
+        std::function<void()> onWarmedUp = std::function<void()>())
+      : config(config),
+        hist(hist),
+        onWarmedUp(onWarmedUp),
+        warmupTaken(0),
+        warmedUp(false),
+        done(false),
+        nextCheck(0),
+        deadline(0),
+        ring(NULL),
+        pointId(0) {
+      if (config.trace != NULL) {
+        ring = config.trace->openRing();
+        pointId = config.trace->getPointId();
+      }
+    }
+
+    ~PointSampler() {
+      if (ring != NULL)
+        config.trace->closeRing(ring);
+    }
+
+    /**
+     * Return true if another sample should be taken.
+     */
+    bool more() {
+      if (warmupTaken < config.warmupSamples)
+        return true;
+
+      if (!warmedUp) {
+        warmedUp = true;
+        if (config.maxSeconds > 0)
+          deadline = Cycles::rdtsc() + Cycles::fromSeconds(config.maxSeconds);
+        nextCheck = config.minSamples;
+        if (onWarmedUp)
+          onWarmedUp();
+      }
+
+      if (done)
+        return false;
+
+      uint64_t count = hist->getCount();
+      if (count >= config.maxSamples) {
+        done = true;
+      } else if (config.ciTarget > 0) {
+        if (deadline != 0 && Cycles::rdtsc() > deadline) {
+          done = true;
+        } else if (count >= nextCheck) {
+          // Checking costs a pass over the histogram, so only check after
+          // every 10% growth in the sample count.
+          nextCheck = count + std::max<uint64_t>(1, count / 10);
+          done = (getRelativeCIWidth(*hist, config) <= config.ciTarget);
+        }
+      }
+
+      return !done;
+    }
+
+    /**
+     * Return true while the samples being taken are warmup samples.
+     */
+    bool warmingUp() const {
+      return warmupTaken < config.warmupSamples;
+    }
+
+    /**
+     * Record the result of the sample just taken. Returns false if it was a
+     * warmup sample and was discarded.
+     *
+     * \param value
+     *      The sample, normally a latency in nanoseconds.
+     * \param opType
+     *      Operation type written to the trace, if any.
+     */
+    bool record(uint64_t value, uint32_t opType = 0) {
+      if (warmupTaken < config.warmupSamples) {
+        warmupTaken++;
+        return false;
+      }
+
+      hist->record(value);
+      if (ring != NULL)
+        config.trace->record(ring, value, opType, pointId);
+      return true;
+    }
+
+    /**
+     * Return the width of the confidence interval of config's percentile in
+     * hist, relative to the percentile. Returns infinity if hist has too
+     * few samples to bound the interval.
+     */
+    static double getRelativeCIWidth(const LatencyHistogram& hist,
+        const Config& config) {
+      double n = (double)hist.getCount();
+      double p = config.ciPercentile / 100.0;
+      double z = normalQuantile(0.5 + config.ciConfidence / 2.0);
+      double spread = z * sqrt(n * p * (1.0 - p));
+
+      double lowRank = floor(n * p - spread);
+      double highRank = ceil(n * p + spread) + 1;
+      if (lowRank < 1 || highRank > n)
+        return INFINITY;
+
+      double value = (double)hist.getPercentile(config.ciPercentile);
+      if (value == 0)
+        return 0;
+      return (double)(hist.getValueAtRank((uint64_t)highRank) -
+          hist.getValueAtRank((uint64_t)lowRank)) / value;
+    }
+
+  PRIVATE:
+    /**
+     * Return z such that a standard normal variable is below z with
+     * probability q.
+     */
+    static double normalQuantile(double q) {
+      double low = -10.0;
+      double high = 10.0;
+      for (int i = 0; i < 100; i++) {
+        double mid = (low + high) / 2.0;
+        if (0.5 * erfc(-mid / sqrt(2.0)) < q)
+          low = mid;
+        else
+          high = mid;
+      }
+      return (low + high) / 2.0;
+    }
+
+    Config config;
+    LatencyHistogram* hist;
+    std::function<void()> onWarmedUp;
+
+    uint32_t warmupTaken;
+    bool warmedUp;
+    bool done;
+
+    /// Sample count at which to next check the confidence interval.
+    uint64_t nextCheck;
+
+    /// Cycle count at which adaptive sampling gives up, or 0.
+    uint64_t deadline;
+
+    /// This sampler's trace ring and point, if tracing.
+    TraceWriter::Ring* ring;
+    uint32_t pointId;
+
+    DISALLOW_COPY_AND_ASSIGN(PointSampler);
+};
+
+#endif // RCPERF_POINTSAMPLER_H
@@ -0,0 +1,166 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef RCPERF_REQUESTARENA_H
+#define RCPERF_REQUESTARENA_H
+
+#include <assert.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include <new>
+
+#include "Exception.h"
+#include "MultiRead.h"
+#include "ObjectBuffer.h"
+#include "Tub.h"
+
+using namespace RAMCloud;
+
+/**
+ * Owns the multiread request objects, request pointer array, result tubs and
+ * value buffer used by an experiment, so none of them need to live on the
+ * stack. An arena is sized once per sweep from the largest parameters in the
+ * sweep and reused for every point and sample, so its pages are faulted in
+ * once up front (the region is mmapped with MAP_POPULATE) rather than on
+ * every point.
+ */
+class RequestArena {
+  PUBLIC:
+    /**
+     * \param maxRequests
+     *      Largest number of multiread requests that will be prepared at
+     *      once, summed over all threads sharing the arena.
+     * \param maxValueSize
+     *      Size in bytes of the value buffer returned by getValue().
+     */
+    RequestArena(uint32_t maxRequests, uint32_t maxValueSize)
+      : maxRequests(maxRequests),
+        maxValueSize(maxValueSize),
+        region(NULL),
+        regionSize(0),
+        objects(NULL),
+        requests(NULL),
+        results(NULL),
+        value(NULL) {
+      size_t objectsOffset = 0;
+      size_t requestsOffset = align(objectsOffset +
+          sizeof(MultiReadObject) * maxRequests);
+      size_t resultsOffset = align(requestsOffset +
+          sizeof(MultiReadObject*) * maxRequests);
+      size_t valueOffset = align(resultsOffset +
+          sizeof(Tub<ObjectBuffer>) * maxRequests);
+      regionSize = align(valueOffset + maxValueSize);
+      if (regionSize == 0)
+        regionSize = ALIGNMENT;
+
+      region = mmap(NULL, regionSize, PROT_READ | PROT_WRITE,
+          MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+      if (region == MAP_FAILED) {
+        region = NULL;
+        throw Exception(HERE, "Could not map request arena", errno);
+      }
+
+      char* base = static_cast<char*>(region);
+      objects = reinterpret_cast<MultiReadObject*>(base + objectsOffset);
+      requests = reinterpret_cast<MultiReadObject**>(base + requestsOffset);
+      results = reinterpret_cast<Tub<ObjectBuffer>*>(base + resultsOffset);
+      value = base + valueOffset;
+
+      for (uint32_t i = 0; i < maxRequests; i++) {
+        new(&objects[i]) MultiReadObject();
+        new(&results[i]) Tub<ObjectBuffer>();
+        requests[i] = &objects[i];
+      }
+    }
+
+    ~RequestArena() {
+      if (region == NULL)
+        return;
+
+      for (uint32_t i = 0; i < maxRequests; i++) {
+        results[i].~Tub<ObjectBuffer>();
+        objects[i].~MultiReadObject();
+      }
+      munmap(region, regionSize);
+    }
+
+    /**
+     * Fill in count multiread requests for consecutive keys, starting at
+     * request first, and return the array of request pointers to pass to
+     * multiRead(). Each request reads into its own result tub in the arena.
+     * Threads sharing an arena must prepare disjoint ranges.
+     *
+     * \param first
+     *      Index of the first request to fill in.
+     * \param tableId
+     *      Table to read from.
+     * \param keys
+     *      count keys of keySize bytes each, stored back to back.
+     * \param keySize
+     *      Size of each key in bytes.
+     * \param count
+     *      Number of requests. first + count must not exceed maxRequests.
+     */
+    MultiReadObject** prepare(uint32_t first, uint64_t tableId,
+        const char* keys, uint16_t keySize, uint32_t count) {
+      assert(first + count <= maxRequests);
+      for (uint32_t i = first; i < first + count; i++) {
+        objects[i] = MultiReadObject(tableId,
+            keys + (uint64_t)(i - first) * keySize, keySize, &results[i]);
+      }
+      return &requests[first];
+    }
+
+    /**
+     * Return the result tub of request i.
+     */
+    Tub<ObjectBuffer>* getResult(uint32_t i) {
+      return &results[i];
+    }
+
+    /**
+     * Return a buffer of maxValueSize bytes to use as the value of objects
+     * written by the experiment.
+     */
+    char* getValue() {
+      return value;
+    }
+
+  PRIVATE:
+    /// Every array in the region starts on a cache line boundary, so threads
+    /// working on adjacent ranges share at most one line per array.
+    static const size_t ALIGNMENT = 64;
+
+    static size_t align(size_t offset) {
+      return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    uint32_t maxRequests;
+    uint32_t maxValueSize;
+
+    /// Anonymous mapping holding all of the arrays below.
+    void* region;
+    size_t regionSize;
+
+    MultiReadObject* objects;
+    MultiReadObject** requests;
+    Tub<ObjectBuffer>* results;
+    char* value;
+
+    DISALLOW_COPY_AND_ASSIGN(RequestArena);
+};
+
+#endif // RCPERF_REQUESTARENA_H
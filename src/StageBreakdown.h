@@ -0,0 +1,232 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef RCPERF_STAGEBREAKDOWN_H
+#define RCPERF_STAGEBREAKDOWN_H
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "Cycles.h"
+#include "TimeTrace.h"
+
+#include "SweepJournal.h"
+
+using namespace RAMCloud;
+
+/**
+ * Accumulates how long the stages of an operation take, for a subset of the
+ * samples of a point. An experiment that supports instrumentation splits an
+ * operation into stages (for example sending the request, waiting for the
+ * response and completing the operation) and, for every sample selected by
+ * sample(), takes a timestamp at the start and at the end of every stage
+ * and passes them to record().
+ *
+ * Every recorded sample is also written to RAMCloud's TimeTrace, as an
+ * "rcperf: sample start" event followed by an "rcperf: end of stage <n>"
+ * event per stage, so the stages line up with RAMCloud's own tracepoints
+ * when the trace is printed.
+ *
+ * Each thread keeps its own StageBreakdown; they are merged after the point.
+ */
+class StageBreakdown {
+  PUBLIC:
+    /**
+     * \param every
+     *      Instrument one out of every this many samples. 0 instruments none.
+     * \param stageCount
+     *      Number of stages the operation is split into.
+     */
+    StageBreakdown(uint32_t every, size_t stageCount)
+      : every(every),
+        countdown(every),
+        count(0),
+        cycles(stageCount, 0) {
+    }
+
+    /**
+     * Return true if the next sample should be instrumented.
+     */
+    bool sample() {
+      if (every == 0 || --countdown > 0)
+        return false;
+      countdown = every;
+      return true;
+    }
+
+    /**
+     * Record an instrumented sample.
+     *
+     * \param timestamps
+     *      Cycle counter at the start of the operation followed by the cycle
+     *      counter at the end of every stage (stageCount + 1 values).
+     */
+    void record(const uint64_t* timestamps) {
+      TimeTrace::record(timestamps[0], "rcperf: sample start");
+      for (size_t i = 0; i < cycles.size(); i++) {
+        cycles[i] += timestamps[i + 1] - timestamps[i];
+        TimeTrace::record(timestamps[i + 1], "rcperf: end of stage %u",
+            (uint32_t)i);
+      }
+      count++;
+    }
+
+    /**
+     * Add the samples recorded by other, which has the same stages.
+     */
+    void merge(const StageBreakdown& other) {
+      for (size_t i = 0; i < cycles.size(); i++)
+        cycles[i] += other.cycles[i];
+      count += other.count;
+    }
+
+    /**
+     * Return the number of instrumented samples.
+     */
+    uint64_t getCount() const {
+      return count;
+    }
+
+    /**
+     * Return the mean time spent in a stage, in nanoseconds.
+     */
+    double getMean(size_t stage) const {
+      if (count == 0)
+        return 0.0;
+      return (double)Cycles::toNanoseconds(cycles[stage]) / count;
+    }
+
+    /**
+     * Return the number of stages.
+     */
+    size_t getStageCount() const {
+      return cycles.size();
+    }
+
+  PRIVATE:
+    uint32_t every;
+
+    /// Samples left until the next instrumented one.
+    uint32_t countdown;
+
+    uint64_t count;
+
+    /// Total cycles spent in each stage by the instrumented samples.
+    std::vector<uint64_t> cycles;
+};
+
+/**
+ * Writes the StageBreakdown of every point of a sweep to a companion of the
+ * sweep's CSV file (<name>.stages.csv): the point's parameter values, the
+ * number of instrumented samples and the mean time of every stage and of
+ * the whole operation in microseconds.
+ *
+ * If instrumentation is on, begin() clears RAMCloud's TimeTrace and end()
+ * prints it to the log, so the log holds the tracepoints of each point.
+ */
+class StageReport {
+  PUBLIC:
+    /**
+     * \param journal
+     *      The sweep's journal, which names the file and tells whether to
+     *      append to it.
+     * \param columns
+     *      Names of the parameter columns, matching the values passed to
+     *      end().
+     * \param stages
+     *      Names of the stages.
+     * \param enabled
+     *      False if no samples are instrumented. Nothing is written then.
+     */
+    StageReport(SweepJournal* journal, const std::vector<const char*>& columns,
+        const std::vector<const char*>& stages, bool enabled)
+      : journal(journal),
+        columns(columns),
+        stages(stages),
+        enabled(enabled),
+        file(NULL) {
+    }
+
+    ~StageReport() {
+      if (file != NULL)
+        fclose(file);
+    }
+
+    /**
+     * Called at the start of a point.
+     */
+    void begin() {
+      if (enabled)
+        TimeTrace::reset();
+    }
+
+    /**
+     * Write a point's breakdown.
+     *
+     * \param values
+     *      The point's parameter values.
+     * \param breakdown
+     *      Stages of the point's instrumented samples, from all threads.
+     */
+    void end(const std::vector<uint32_t>& values,
+        const StageBreakdown& breakdown) {
+      if (!enabled)
+        return;
+      TimeTrace::printToLog();
+      open();
+
+      for (size_t v = 0; v < values.size(); v++)
+        fprintf(file, (v == 0) ? "%12u" : " %12u", values[v]);
+      fprintf(file, " %12lu", breakdown.getCount());
+      double total = 0.0;
+      for (size_t i = 0; i < breakdown.getStageCount(); i++) {
+        fprintf(file, " %12.3f", breakdown.getMean(i) / 1000.0);
+        total += breakdown.getMean(i);
+      }
+      fprintf(file, " %12.3f\n", total / 1000.0);
+      fflush(file);
+    }
+
+  PRIVATE:
+    /**
+     * Open the file the first time it is needed, once the sweep's header
+     * has been written.
+     */
+    void open() {
+      if (file != NULL)
+        return;
+
+      file = journal->openCompanion(journal->getCompanionFilename("stages"));
+      if (ftell(file) > 0)
+        return;
+      for (size_t i = 0; i < columns.size(); i++)
+        fprintf(file, (i == 0) ? "%12s" : " %12s", columns[i]);
+      fprintf(file, " %12s", "Instrumented");
+      for (size_t i = 0; i < stages.size(); i++)
+        fprintf(file, " %12s", stages[i]);
+      fprintf(file, " %12s\n", "Total");
+    }
+
+    SweepJournal* journal;
+    std::vector<const char*> columns;
+    std::vector<const char*> stages;
+    bool enabled;
+    FILE* file;
+
+    DISALLOW_COPY_AND_ASSIGN(StageReport);
+};
+
+#endif // RCPERF_STAGEBREAKDOWN_H
@@ -0,0 +1,357 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef RCPERF_SWEEPJOURNAL_H
+#define RCPERF_SWEEPJOURNAL_H
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Exception.h"
+
+using namespace RAMCloud;
+
+/**
+ * Records which points of a sweep have been written to its CSV file, so an
+ * interrupted sweep can be resumed where it stopped.
+ *
+ * Every completed point is appended to <csv>.journal as a line holding the
+ * hash of the configuration that produced it, the size of the CSV file after
+ * the point's rows, the point's parameter values and, as <file>=<size>, the
+ * size of every open companion file (see openCompanion()). When resuming,
+ * points in the journal are skipped and the CSV file and its companions are
+ * kept up to the end of the last journaled point (rows of a point that was
+ * cut off are dropped), so new rows are appended after the old ones. The journal is only used if
+ * every entry carries the current configuration hash and the CSV header is
+ * unchanged; otherwise the sweep starts over.
+ *
+ * Typical use:
+ *
+ *     SweepJournal journal(filename, configHash, resume);
+ *     FILE* datFile = journal.openOutput();
+ *     ... write the header ...
+ *     for (each point) {
+ *       if (journal.isDone({a, b}))
+ *         continue;
+ *       ... measure and write the point's rows ...
+ *       journal.markDone({a, b});
+ *     }
+ */
+class SweepJournal {
+  PUBLIC:
+    /**
+     * \param csvFilename
+     *      Name of the sweep's CSV file.
+     * \param configHash
+     *      Hash of everything in the configuration that affects the sweep.
+     * \param resume
+     *      If true, pick up from an existing journal. Otherwise any existing
+     *      journal and CSV file are overwritten.
+     */
+    SweepJournal(const std::string& csvFilename, uint32_t configHash,
+        bool resume)
+      : csvFilename(csvFilename),
+        journalFilename(csvFilename + ".journal"),
+        configHash(configHash),
+        done(),
+        resumeOffset(0),
+        oldHeader(),
+        companionOffsets(),
+        companions(),
+        resuming(false),
+        started(false),
+        output(NULL),
+        journal(NULL) {
+      if (resume)
+        resuming = load();
+
+      journal = fopen(journalFilename.c_str(), resuming ? "a" : "w");
+      if (journal == NULL) {
+        throw Exception(HERE, "Could not open journal " + journalFilename,
+            errno);
+      }
+    }
+
+    ~SweepJournal() {
+      fclose(journal);
+    }
+
+    /**
+     * Open the CSV file for writing and return it. The caller writes the
+     * header and closes the file when the sweep is done. When resuming, the
+     * header overwrites the identical old one, and the file is positioned
+     * after the journaled rows by the first isDone() call.
+     */
+    FILE* openOutput() {
+      output = fopen(csvFilename.c_str(), resuming ? "r+" : "w");
+      if (output == NULL) {
+        throw Exception(HERE, "Could not open output file " + csvFilename,
+            errno);
+      }
+      return output;
+    }
+
+    /**
+     * Return true if point has already been measured. If rest is not
+     * empty, point is the prefix of a group of points, one for every
+     * combination of the values in rest, and true is returned only if every
+     * point in the group has been measured. This lets a sweep skip loading
+     * a dataset when no remaining point needs it.
+     */
+    bool isDone(const std::vector<uint32_t>& point,
+        const std::vector<std::vector<uint32_t>>& rest =
+            std::vector<std::vector<uint32_t>>()) {
+      start();
+      return isGroupDone(point, rest, 0);
+    }
+
+    /**
+     * Record that all of point's rows have been written.
+     */
+    void markDone(const std::vector<uint32_t>& point) {
+      start();
+      fflush(output);
+      std::string key = makeKey(point);
+      fprintf(journal, "%08x %ld %s", configHash, ftell(output),
+          key.c_str());
+      for (size_t i = 0; i < companions.size(); i++) {
+        fflush(companions[i].second);
+        fprintf(journal, " %s=%ld", companions[i].first.c_str(),
+            ftell(companions[i].second));
+      }
+      fprintf(journal, "\n");
+      fflush(journal);
+      done.insert(key);
+    }
+
+    /**
+     * Return the name of a file holding more results for the sweep's
+     * points: the CSV file's name with ".csv" replaced by ".<kind>.csv".
+     */
+    std::string getCompanionFilename(const char* kind) const {
+      std::string name(csvFilename);
+      if (name.size() >= 4 && name.compare(name.size() - 4, 4, ".csv") == 0)
+        name.erase(name.size() - 4);
+      return name + "." + kind + ".csv";
+    }
+
+    /**
+     * Open a companion file (see getCompanionFilename()) for writing. When
+     * resuming it is cut back to its size at the end of the last journaled
+     * point and appended to; otherwise it is overwritten. The caller writes
+     * a header if it is empty, and must keep the file open until the
+     * journal's last markDone(). Must be called after the CSV file's header
+     * has been written.
+     */
+    FILE* openCompanion(const std::string& filename) {
+      start();
+      FILE* file = fopen(filename.c_str(), resuming ? "a" : "w");
+      if (file == NULL) {
+        throw Exception(HERE, "Could not open output file " + filename,
+            errno);
+      }
+
+      if (resuming) {
+        // A companion the journal doesn't know only holds rows of points
+        // that were cut off.
+        std::map<std::string, long>::iterator it =
+            companionOffsets.find(filename);
+        long offset = (it == companionOffsets.end()) ? 0 : it->second;
+        fseek(file, 0, SEEK_END);
+        if (ftell(file) > offset)
+          truncate(file, filename, offset);
+      }
+      fseek(file, 0, SEEK_END);
+      companions.push_back(std::make_pair(filename, file));
+      return file;
+    }
+
+  PRIVATE:
+    /**
+     * Read the journal of a previous run. Returns false, leaving the sweep
+     * to start over, if there is nothing usable to resume from.
+     */
+    bool load() {
+      FILE* old = fopen(journalFilename.c_str(), "r");
+      if (old == NULL)
+        return false;
+
+      char line[4096];
+      bool ok = true;
+      while (fgets(line, sizeof(line), old) != NULL) {
+        unsigned int hash;
+        long offset;
+        char key[1024];
+        int consumed = 0;
+        if (sscanf(line, "%x %ld %1023s%n", &hash, &offset, key,
+            &consumed) != 3)
+          continue;
+        if (hash != configHash) {
+          printf("WARNING: %s was written with a different configuration. Starting the sweep over.\n",
+              journalFilename.c_str());
+          ok = false;
+          break;
+        }
+        done.insert(key);
+        resumeOffset = offset;
+
+        char companion[1024];
+        long companionOffset;
+        const char* rest = line + consumed;
+        while (sscanf(rest, " %1023[^= \n]=%ld%n", companion,
+            &companionOffset, &consumed) == 2) {
+          companionOffsets[companion] = companionOffset;
+          rest += consumed;
+        }
+      }
+      fclose(old);
+
+      if (!ok || done.empty()) {
+        done.clear();
+        return false;
+      }
+
+      // Remember the old header to check it against the new one.
+      FILE* csv = fopen(csvFilename.c_str(), "r");
+      if (csv == NULL || fgets(line, sizeof(line), csv) == NULL ||
+          fseek(csv, 0, SEEK_END) != 0 || ftell(csv) < resumeOffset) {
+        printf("WARNING: %s is missing or shorter than its journal. Starting the sweep over.\n",
+            csvFilename.c_str());
+        if (csv != NULL)
+          fclose(csv);
+        done.clear();
+        return false;
+      }
+      oldHeader = line;
+      fclose(csv);
+
+      printf("Resuming %s: %lu points already measured\n",
+          csvFilename.c_str(), done.size());
+      return true;
+    }
+
+    /**
+     * Called once the header has been written. When resuming, check the
+     * header and move past the journaled rows.
+     */
+    void start() {
+      if (started)
+        return;
+      started = true;
+      if (!resuming)
+        return;
+
+      fflush(output);
+      long headerSize = ftell(output);
+      bool same = (headerSize == (long)oldHeader.size());
+      if (same) {
+        std::vector<char> header(headerSize);
+        same = (pread(fileno(output), &header[0], headerSize, 0) ==
+            headerSize) && memcmp(&header[0], oldHeader.data(), headerSize) == 0;
+      }
+
+      if (!same) {
+        printf("WARNING: The columns of %s have changed. Starting the sweep over.\n",
+            csvFilename.c_str());
+        done.clear();
+        resuming = false;
+        resumeOffset = headerSize;
+        fclose(journal);
+        journal = fopen(journalFilename.c_str(), "w");
+        if (journal == NULL) {
+          throw Exception(HERE, "Could not open journal " + journalFilename,
+              errno);
+        }
+      }
+
+      // Drop anything written after the last journaled point.
+      truncate(output, csvFilename, resumeOffset);
+    }
+
+    /**
+     * Cut an output file back to offset and position it there.
+     */
+    static void truncate(FILE* file, const std::string& filename,
+        long offset) {
+      fflush(file);
+      fseek(file, offset, SEEK_SET);
+      if (ftruncate(fileno(file), offset) != 0) {
+        throw Exception(HERE, "Could not truncate output file " + filename,
+            errno);
+      }
+    }
+
+    bool isGroupDone(const std::vector<uint32_t>& prefix,
+        const std::vector<std::vector<uint32_t>>& rest, size_t depth) const {
+      if (depth == rest.size())
+        return done.count(makeKey(prefix)) > 0;
+
+      std::vector<uint32_t> point(prefix);
+      point.push_back(0);
+      for (size_t i = 0; i < rest[depth].size(); i++) {
+        point.back() = rest[depth][i];
+        if (!isGroupDone(point, rest, depth + 1))
+          return false;
+      }
+      return true;
+    }
+
+    static std::string makeKey(const std::vector<uint32_t>& point) {
+      std::string key;
+      for (size_t i = 0; i < point.size(); i++) {
+        if (i > 0)
+          key += ",";
+        key += std::to_string(point[i]);
+      }
+      return key;
+    }
+
+    std::string csvFilename;
+    std::string journalFilename;
+    uint32_t configHash;
+
+    /// Keys of the points measured so far.
+    std::set<std::string> done;
+
+    /// Size of the CSV file at the end of the last journaled point.
+    long resumeOffset;
+
+    /// First line of the CSV file being resumed.
+    std::string oldHeader;
+
+    /// Size of every companion file at the end of the last journaled point
+    /// that had it open, by file name.
+    std::map<std::string, long> companionOffsets;
+
+    /// Companion files opened by openCompanion(), by file name.
+    std::vector<std::pair<std::string, FILE*>> companions;
+
+    bool resuming;
+    bool started;
+    FILE* output;
+    FILE* journal;
+
+    DISALLOW_COPY_AND_ASSIGN(SweepJournal);
+};
+
+#endif // RCPERF_SWEEPJOURNAL_H
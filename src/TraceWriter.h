@@ -0,0 +1,321 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef RCPERF_TRACEWRITER_H
+#define RCPERF_TRACEWRITER_H
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Cycles.h"
+#include "Exception.h"
+
+using namespace RAMCloud;
+
+/**
+ * Layout of the binary trace files written by TraceWriter and read by
+ * rctrace: a TraceFileHeader followed by TraceRecords back to back, in the
+ * byte order of the machine that wrote them.
+ */
+struct TraceFileHeader {
+  /// TRACE_MAGIC.
+  char magic[8];
+  uint32_t version;
+  uint32_t recordSize;
+  /// Converts record timestamps to seconds.
+  double cyclesPerSecond;
+};
+
+static const char TRACE_MAGIC[8] = {'R', 'C', 'T', 'R', 'A', 'C', 'E', 0};
+static const uint32_t TRACE_VERSION = 1;
+
+/// One measured sample.
+struct TraceRecord {
+  /// Cycle counter when the sample was recorded (its end).
+  uint64_t timestamp;
+  uint64_t latencyNs;
+  /// Experiment-specific operation type, e.g. a YcsbWorkload::Operation.
+  uint32_t opType;
+  /// Index of the point in the .points file written next to the trace.
+  uint32_t pointId;
+};
+
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord must be 24 bytes");
+
+/**
+ * Writes every measured sample of a run to a binary trace file, so samples
+ * can be examined offline beyond the percentiles kept in the CSV files.
+ *
+ * Each measuring thread pushes records into its own single-producer,
+ * single-consumer ring, and a background thread drains all of the rings to
+ * the file. Pushing never blocks and never takes a lock; if a ring is full
+ * the record is dropped and counted. Points are described in a text file
+ * next to the trace (<file>.points), one "<id> <csv file> <values>" line per
+ * point.
+ *
+ * A TraceWriter constructed with an empty filename is disabled: it opens no
+ * rings and records nothing.
+ */
+class TraceWriter {
+  PUBLIC:
+    /**
+     * A ring of records filled by one thread.
+     */
+    class Ring {
+      PUBLIC:
+        Ring()
+          : records(CAPACITY),
+            head(0),
+            tail(0),
+            closed(false) {
+        }
+
+        /**
+         * Add a record. Returns false if the ring is full and the record
+         * was dropped.
+         */
+        bool push(const TraceRecord& record) {
+          uint64_t h = head.load(std::memory_order_relaxed);
+          if (h - tail.load(std::memory_order_acquire) == CAPACITY)
+            return false;
+          records[h & (CAPACITY - 1)] = record;
+          head.store(h + 1, std::memory_order_release);
+          return true;
+        }
+
+      PRIVATE:
+        static const uint64_t CAPACITY = 1 << 16;
+
+        std::vector<TraceRecord> records;
+
+        /// Written by the producer only.
+        std::atomic<uint64_t> head;
+        /// Keeps head and tail on different cache lines, so the producer
+        /// and the writer thread don't share lines.
+        char padding[64];
+        /// Written by the writer thread only.
+        std::atomic<uint64_t> tail;
+        /// Set by the producer when it is done with the ring.
+        std::atomic<bool> closed;
+
+        friend class TraceWriter;
+        DISALLOW_COPY_AND_ASSIGN(Ring);
+    };
+
+    /**
+     * \param filename
+     *      Trace file to write. Empty disables tracing.
+     */
+    explicit TraceWriter(const std::string& filename)
+      : filename(filename),
+        file(NULL),
+        pointsFile(NULL),
+        rings(),
+        mutex(),
+        thread(),
+        stopping(false),
+        nextPointId(0),
+        currentPointId(0),
+        recorded(0),
+        dropped(0) {
+      if (filename.empty())
+        return;
+
+      file = fopen(filename.c_str(), "w");
+      std::string pointsFilename = filename + ".points";
+      pointsFile = fopen(pointsFilename.c_str(), "w");
+      if (file == NULL || pointsFile == NULL) {
+        throw Exception(HERE, "Could not open trace file " + filename,
+            errno);
+      }
+
+      TraceFileHeader header;
+      memset(&header, 0, sizeof(header));
+      memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+      header.version = TRACE_VERSION;
+      header.recordSize = sizeof(TraceRecord);
+      header.cyclesPerSecond = Cycles::perSecond();
+      fwrite(&header, sizeof(header), 1, file);
+
+      thread = std::thread(&TraceWriter::writerMain, this);
+    }
+
+    ~TraceWriter() {
+      if (file == NULL)
+        return;
+
+      stopping = true;
+      thread.join();
+      for (std::list<Ring*>::iterator it = rings.begin(); it != rings.end();
+          it++) {
+        delete *it;
+      }
+      fclose(file);
+      fclose(pointsFile);
+      printf("Trace: wrote %lu samples to %s (%lu dropped)\n",
+          recorded, filename.c_str(), dropped.load());
+    }
+
+    bool isEnabled() const {
+      return file != NULL;
+    }
+
+    /**
+     * Start a new point. Rings opened from now on tag their records with
+     * the new point's id.
+     *
+     * \param csvFilename
+     *      Output file the point's results go to.
+     * \param values
+     *      The point's parameter values, in the order of its CSV columns.
+     */
+    void beginPoint(const char* csvFilename,
+        const std::vector<uint32_t>& values) {
+      if (file == NULL)
+        return;
+
+      uint32_t id = nextPointId++;
+      fprintf(pointsFile, "%u %s", id, csvFilename);
+      for (size_t i = 0; i < values.size(); i++)
+        fprintf(pointsFile, "%s%u", (i == 0) ? " " : ",", values[i]);
+      fprintf(pointsFile, "\n");
+      fflush(pointsFile);
+      currentPointId = id;
+    }
+
+    /**
+     * Return the id of the current point.
+     */
+    uint32_t getPointId() const {
+      return currentPointId;
+    }
+
+    /**
+     * Return a new ring for the calling thread, or NULL if tracing is
+     * disabled. Pass it to closeRing() when done.
+     */
+    Ring* openRing() {
+      if (file == NULL)
+        return NULL;
+
+      Ring* ring = new Ring();
+      std::lock_guard<std::mutex> lock(mutex);
+      rings.push_back(ring);
+      return ring;
+    }
+
+    /**
+     * Give up a ring. The writer thread frees it once it has been drained.
+     */
+    void closeRing(Ring* ring) {
+      if (ring != NULL)
+        ring->closed = true;
+    }
+
+    /**
+     * Record a sample in ring, counting it as dropped if the ring is full.
+     */
+    void record(Ring* ring, uint64_t latencyNs, uint32_t opType,
+        uint32_t pointId) {
+      TraceRecord record = {Cycles::rdtsc(), latencyNs, opType, pointId};
+      if (!ring->push(record))
+        dropped++;
+    }
+
+  PRIVATE:
+    /**
+     * Body of the writer thread: drain every ring until stopped, then drain
+     * them one last time.
+     */
+    void writerMain() {
+      while (true) {
+        bool last = stopping;
+        std::vector<Ring*> current;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          current.assign(rings.begin(), rings.end());
+        }
+
+        uint64_t written = 0;
+        for (size_t i = 0; i < current.size(); i++) {
+          // Read closed before draining, so a closed ring is empty once
+          // drained.
+          bool closed = current[i]->closed;
+          written += drain(current[i]);
+          if (closed) {
+            std::lock_guard<std::mutex> lock(mutex);
+            rings.remove(current[i]);
+            delete current[i];
+          }
+        }
+
+        if (last)
+          break;
+        if (written == 0)
+          usleep(1000);
+      }
+      fflush(file);
+    }
+
+    /**
+     * Write out everything in ring. Returns the number of records written.
+     */
+    uint64_t drain(Ring* ring) {
+      uint64_t t = ring->tail.load(std::memory_order_relaxed);
+      uint64_t h = ring->head.load(std::memory_order_acquire);
+      uint64_t count = h - t;
+      while (t != h) {
+        // Write up to the end of the ring in one go.
+        uint64_t index = t & (Ring::CAPACITY - 1);
+        uint64_t n = std::min(h - t, Ring::CAPACITY - index);
+        fwrite(&ring->records[index], sizeof(TraceRecord), n, file);
+        t += n;
+      }
+      ring->tail.store(t, std::memory_order_release);
+      recorded += count;
+      return count;
+    }
+
+    std::string filename;
+    FILE* file;
+    FILE* pointsFile;
+
+    /// Open rings, and rings closed but not yet drained.
+    std::list<Ring*> rings;
+    std::mutex mutex;
+    std::thread thread;
+    std::atomic<bool> stopping;
+
+    uint32_t nextPointId;
+    std::atomic<uint32_t> currentPointId;
+
+    /// Only updated by the writer thread.
+    uint64_t recorded;
+    std::atomic<uint64_t> dropped;
+
+    DISALLOW_COPY_AND_ASSIGN(TraceWriter);
+};
+
+#endif // RCPERF_TRACEWRITER_H
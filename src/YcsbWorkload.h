@@ -0,0 +1,355 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef RCPERF_YCSBWORKLOAD_H
+#define RCPERF_YCSBWORKLOAD_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+
+#include "Common.h"
+
+/**
+ * The number of records in a YCSB table, shared by all of the threads
+ * running a workload. Inserts claim record numbers in order but their
+ * writes can finish in any order, so a record only counts once it and
+ * every record before it have been written (YCSB's
+ * AcknowledgedCounterGenerator). Reads therefore never choose a record
+ * whose insert is still in flight.
+ */
+class YcsbRecordCount {
+  PUBLIC:
+    /**
+     * \param count
+     *      Number of records already in the table.
+     */
+    explicit YcsbRecordCount(uint32_t count)
+      : next(count),
+        acknowledged(count),
+        mutex(),
+        finished() {
+    }
+
+    /**
+     * Claim the number of a new record.
+     */
+    uint32_t claim() {
+      return next.fetch_add(1);
+    }
+
+    /**
+     * Record that the write of a claimed record has finished.
+     */
+    void acknowledge(uint32_t record) {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished.insert(record);
+      uint32_t count = acknowledged;
+      while (!finished.empty() && *finished.begin() == count) {
+        finished.erase(finished.begin());
+        count++;
+      }
+      acknowledged = count;
+    }
+
+    /**
+     * Return the number of records written, all of them numbered below
+     * the count.
+     */
+    uint32_t get() const {
+      return acknowledged;
+    }
+
+  PRIVATE:
+    /// Number of the next record to claim.
+    std::atomic<uint32_t> next;
+    std::atomic<uint32_t> acknowledged;
+
+    /// Acknowledged records above a gap left by an unfinished insert.
+    std::mutex mutex;
+    std::set<uint32_t> finished;
+
+    DISALLOW_COPY_AND_ASSIGN(YcsbRecordCount);
+};
+
+/**
+ * Chooses operations and records for a YCSB-style mixed workload over a
+ * table of numbered records. Each client thread owns one instance; threads
+ * share only the YcsbRecordCount of the table, which grows as records are
+ * inserted.
+ *
+ * Operation mixes and key choosers follow YCSB's CoreWorkload:
+ *   - UNIFORM: every record equally likely.
+ *   - ZIPFIAN: Zipfian popularity with parameter theta, with popular records
+ *     scattered over the key space by hashing (YCSB's "scrambled" Zipfian).
+ *   - LATEST: Zipfian popularity by age, so recently inserted records are
+ *     the most popular.
+ *   - HOTSPOT: hotOpFraction of operations go uniformly to the first
+ *     hotDataFraction of records, the rest uniformly to the others.
+ */
+class YcsbWorkload {
+  PUBLIC:
+    enum Operation {
+      READ,
+      UPDATE,
+      INSERT,
+      SCAN,
+      READ_MODIFY_WRITE,
+      NUM_OPERATIONS
+    };
+
+    enum Distribution {
+      UNIFORM,
+      ZIPFIAN,
+      LATEST,
+      HOTSPOT
+    };
+
+    /// Everything that defines a workload, other than the record count.
+    struct Config {
+      /// Relative frequency of each Operation. Need not sum to 1.
+      double proportions[NUM_OPERATIONS];
+      Distribution distribution;
+      double zipfianTheta;
+      double hotDataFraction;
+      double hotOpFraction;
+      /// Scan lengths are uniform between 1 and this.
+      uint32_t maxScanLength;
+    };
+
+    /**
+     * Fill in config with one of the standard YCSB core workloads, "a"
+     * through "f". Returns false for any other name.
+     */
+    static bool getPreset(const std::string& name, Config* config) {
+      Config preset = {{0, 0, 0, 0, 0}, ZIPFIAN, 0.99, 0.2, 0.8, 100};
+      if (name.compare("a") == 0) {
+        // Update heavy.
+        preset.proportions[READ] = 0.5;
+        preset.proportions[UPDATE] = 0.5;
+      } else if (name.compare("b") == 0) {
+        // Read mostly.
+        preset.proportions[READ] = 0.95;
+        preset.proportions[UPDATE] = 0.05;
+      } else if (name.compare("c") == 0) {
+        // Read only.
+        preset.proportions[READ] = 1.0;
+      } else if (name.compare("d") == 0) {
+        // Read latest.
+        preset.proportions[READ] = 0.95;
+        preset.proportions[INSERT] = 0.05;
+        preset.distribution = LATEST;
+      } else if (name.compare("e") == 0) {
+        // Short ranges.
+        preset.proportions[SCAN] = 0.95;
+        preset.proportions[INSERT] = 0.05;
+      } else if (name.compare("f") == 0) {
+        // Read-modify-write.
+        preset.proportions[READ] = 0.5;
+        preset.proportions[READ_MODIFY_WRITE] = 0.5;
+      } else {
+        return false;
+      }
+
+      *config = preset;
+      return true;
+    }
+
+    /**
+     * Parse a distribution name (uniform, zipfian, latest or hotspot).
+     * Returns false if the name is unknown.
+     */
+    static bool parseDistribution(const std::string& name,
+        Distribution* distribution) {
+      if (name.compare("uniform") == 0)
+        *distribution = UNIFORM;
+      else if (name.compare("zipfian") == 0)
+        *distribution = ZIPFIAN;
+      else if (name.compare("latest") == 0)
+        *distribution = LATEST;
+      else if (name.compare("hotspot") == 0)
+        *distribution = HOTSPOT;
+      else
+        return false;
+      return true;
+    }
+
+    static const char* operationName(Operation operation) {
+      static const char* const names[NUM_OPERATIONS] =
+          {"READ", "UPDATE", "INSERT", "SCAN", "RMW"};
+      return names[operation];
+    }
+
+    /**
+     * \param config
+     *      Operation mix and key chooser.
+     * \param recordCount
+     *      Records currently in the table, shared by all threads. Records
+     *      are numbered from 0, and insert() claims the next number.
+     * \param seed
+     *      Seed for this instance's random number generator. Use a different
+     *      one for every thread.
+     */
+    YcsbWorkload(const Config& config, YcsbRecordCount* recordCount,
+        uint64_t seed)
+      : config(config),
+        recordCount(recordCount),
+        generator(seed),
+        uniform(0.0, 1.0),
+        zipfianItems(0),
+        zeta(0.0),
+        zeta2Theta(0.0) {
+      double total = 0;
+      for (int i = 0; i < NUM_OPERATIONS; i++)
+        total += config.proportions[i];
+      double cumulative = 0;
+      for (int i = 0; i < NUM_OPERATIONS; i++) {
+        cumulative += config.proportions[i];
+        thresholds[i] = cumulative / total;
+      }
+
+      zeta2Theta = 1.0 + pow(0.5, config.zipfianTheta);
+      growZipfian(recordCount->get());
+    }
+
+    /**
+     * Choose the next operation to perform.
+     */
+    Operation nextOperation() {
+      double u = uniform(generator);
+      for (int i = 0; i < NUM_OPERATIONS - 1; i++) {
+        if (u < thresholds[i])
+          return static_cast<Operation>(i);
+      }
+      return static_cast<Operation>(NUM_OPERATIONS - 1);
+    }
+
+    /**
+     * Choose an existing record for a read, update, read-modify-write or
+     * the start of a scan.
+     */
+    uint32_t nextRecord() {
+      uint32_t count = recordCount->get();
+      switch (config.distribution) {
+        case ZIPFIAN:
+          return fnvHash(nextZipfian(count)) % count;
+        case LATEST:
+          return count - 1 - nextZipfian(count);
+        case HOTSPOT: {
+          uint32_t hotCount = std::max(1U,
+              (uint32_t)(count * config.hotDataFraction));
+          if (uniform(generator) < config.hotOpFraction || hotCount >= count)
+            return nextUniform(hotCount);
+          return hotCount + nextUniform(count - hotCount);
+        }
+        case UNIFORM:
+        default:
+          return nextUniform(count);
+      }
+    }
+
+    /**
+     * Claim the number of a new record to insert. Pass it to inserted()
+     * once its write has returned.
+     */
+    uint32_t insert() {
+      return recordCount->claim();
+    }
+
+    /**
+     * Record that the insert of a record returned by insert() is done, so
+     * that it can be chosen by nextRecord().
+     */
+    void inserted(uint32_t record) {
+      recordCount->acknowledge(record);
+    }
+
+    /**
+     * Choose the number of records for a scan.
+     */
+    uint32_t nextScanLength() {
+      return 1 + nextUniform(config.maxScanLength);
+    }
+
+  PRIVATE:
+    uint32_t nextUniform(uint32_t count) {
+      return std::min(count - 1, (uint32_t)(uniform(generator) * count));
+    }
+
+    /**
+     * Return a Zipfian distributed rank between 0 and count - 1, with rank 0
+     * the most popular (Gray et al., "Quickly Generating Billion-Record
+     * Synthetic Databases", as used by YCSB).
+     */
+    uint32_t nextZipfian(uint32_t count) {
+      if (count > zipfianItems)
+        growZipfian(count);
+
+      double theta = config.zipfianTheta;
+      double alpha = 1.0 / (1.0 - theta);
+      double eta = (1.0 - pow(2.0 / count, 1.0 - theta)) /
+          (1.0 - zeta2Theta / zeta);
+
+      double u = uniform(generator);
+      double uz = u * zeta;
+      if (uz < 1.0)
+        return 0;
+      if (uz < 1.0 + pow(0.5, theta))
+        return std::min(1U, count - 1);
+      return std::min(count - 1,
+          (uint32_t)(count * pow(eta * u - eta + 1.0, alpha)));
+    }
+
+    /**
+     * Extend the zeta constant to cover count items. The table only grows,
+     * so this is incremental.
+     */
+    void growZipfian(uint32_t count) {
+      for (uint64_t i = zipfianItems + 1; i <= count; i++)
+        zeta += 1.0 / pow((double)i, config.zipfianTheta);
+      zipfianItems = count;
+    }
+
+    static uint64_t fnvHash(uint64_t value) {
+      uint64_t hash = 0xCBF29CE484222325UL;
+      for (int i = 0; i < 8; i++) {
+        hash ^= value & 0xff;
+        hash *= 0x100000001B3UL;
+        value >>= 8;
+      }
+      return hash;
+    }
+
+    Config config;
+    YcsbRecordCount* recordCount;
+    std::mt19937_64 generator;
+    std::uniform_real_distribution<double> uniform;
+
+    /// Cumulative, normalized operation proportions.
+    double thresholds[NUM_OPERATIONS];
+
+    /// Number of items zeta currently covers.
+    uint32_t zipfianItems;
+    double zeta;
+    double zeta2Theta;
+};
+
+#endif // RCPERF_YCSBWORKLOAD_H
@@ -18,9 +18,12 @@
 #include <getopt.h>
 #include <assert.h>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <fstream>
+#include <random>
+#include <vector>
 
 #include "ClusterMetrics.h"
 #include "Context.h"
@@ -33,75 +36,679 @@
 #include "RamCloud.h"
 #include "Tub.h"
 #include "IndexLookup.h"
+#include "MultiRead.h"
 #include "TableEnumerator.h"
 #include "Transaction.h"
 
+#include "ClientThreads.h"
+#include "LatencyHistogram.h"
+
 using namespace RAMCloud;
 
+/**
+ * A list of elements stored in RAMCloud as segments. Segment "0" is the head
+ * segment: a uint32_t count of tail segments followed by the most recently
+ * appended elements. When an append would grow the head segment past
+ * head_segment_size, its elements (with the new one) move to a new tail
+ * segment, "1", "2", ... in order of creation. Each element is stored as a
+ * uint32_t size followed by its bytes. The elements of a segment (past the
+ * head segment's count) are laid out in one of two ways:
+ *   - FRONT_INSERT: newest first. Every append shifts the whole segment,
+ *     and finding the k'th element means walking the k before it.
+ *   - TAIL_APPEND: oldest first, followed by a footer of one uint32_t
+ *     offset per element (from the start of the elements) and a uint32_t
+ *     element count. Appends add to the end and extend the footer, and any
+ *     element is found in constant time through the footer.
+ *
+ * Appends write the head segment on the condition that its version is the
+ * one the append started from, and start over if another writer got there
+ * first, so any number of List instances, on any number of clients, can
+ * append to the same list. With cacheHead set, the list keeps a copy of the
+ * head segment and its version and appends don't read it first; the copy is
+ * only read again after a conflict.
+ *
+ * New segments are built in buffers kept by the List and reused by every
+ * append; a new cached head segment becomes the cache without another copy.
+ * The layout is still rebuilt by every append, since RAMCloud writes take a
+ * value as one contiguous block.
+ *
+ * check() reads the tail segments one at a time; readAll() fetches them
+ * with pipelined multiReads and decodes them in place.
+ *
+ * Elements have positions in the order they were appended, starting at 0.
+ * To find positions without walking the list, the "index" object holds the
+ * number of elements of every tail segment, as one uint32_t per segment
+ * from segment 1 on. Tail segments never change, so the index only grows,
+ * by one count at every split; a count of 0 means the segment's split has
+ * not indexed it yet.
+ *
+ * A split writes the empty head segment before the new tail segment and
+ * then indexes it, so a reader can briefly see a tail segment count that
+ * includes a segment not yet written or indexed. With transactionalSplits
+ * set, all three are written in one Transaction instead.
+ */
 class List {
   PUBLIC:
+    enum Layout {
+      FRONT_INSERT,
+      TAIL_APPEND
+    };
+
     RamCloud* client;
     uint64_t tableId;
     uint32_t head_segment_size;
     uint32_t key_size;
+    Layout layout;
+    bool cacheHead;
+    bool transactionalSplits;
+
+    /// Number of appends started over because another writer changed the
+    /// head segment first.
+    uint64_t conflicts;
+    /// Number of those conflicts detected by an aborted split transaction.
+    uint64_t aborts;
+    /// Number of appends that created a tail segment.
+    uint64_t splits;
+    /// Cycles spent building new segments on the client, over all appends.
+    uint64_t buildCycles;
 
-    List(RamCloud* client, uint64_t tableId, uint32_t head_segment_size) : 
+    /**
+     * \param create
+     *      If true, write a new empty list, replacing any list already in
+     *      the table. Otherwise use the existing list.
+     * \param layout
+     *      Layout of the list's segments. Must match the existing list's if
+     *      create is false.
+     */
+    List(RamCloud* client, uint64_t tableId, uint32_t head_segment_size,
+        bool cacheHead = false, bool create = true,
+        Layout layout = FRONT_INSERT) : 
       client(client),
       tableId(tableId),
       head_segment_size(head_segment_size),
-      key_size(30) {
+      key_size(30),
+      layout(layout),
+      cacheHead(cacheHead),
+      transactionalSplits(false),
+      conflicts(0),
+      aborts(0),
+      splits(0),
+      buildCycles(0),
+      head(),
+      headVersion(0),
+      headCached(false),
+      newHead(),
+      newTail(),
+      segCounts(),
+      segCountsVersion(0),
+      segCountsCached(false) {
+      if (!create)
+        return;
      
       char key[key_size];
       memset(key, 0, key_size);
       sprintf(key, "%d", 0); 
-      char value[sizeof(uint32_t)];
-      memset(value, 0, sizeof(uint32_t));
-      client->write(tableId, key, key_size, value, sizeof(uint32_t));
+      // No tail segments (and, for TAIL_APPEND, no elements).
+      newHead.assign((layout == TAIL_APPEND) ? 2 * sizeof(uint32_t) :
+          sizeof(uint32_t), 0);
+      writeHead(key, NULL);
+
+      memset(key, 0, key_size);
+      sprintf(key, "index"); 
+      client->write(tableId, key, key_size, "", 0, NULL, &segCountsVersion);
+      segCounts.clear();
+      segCountsCached = true;
     }
 
     void append(char* data, uint32_t size) {
       char key[key_size];
       memset(key, 0, key_size);
       sprintf(key, "%d", 0); 
+
+      while (true) {
+        Buffer value;
+        if (!headCached && !readHead(&value))
+          return;
+
+        bool appended;
+        if (cacheHead)
+          appended = appendToHead(key, &head[0], head.size(), data, size);
+        else
+          appended = appendToHead(key, (char*)value.getRange(0, value.size()),
+              value.size(), data, size);
+        if (appended)
+          return;
+
+        // Another writer changed the head segment first.
+        headCached = false;
+        conflicts++;
+      }
+    }
+
+    /**
+     * Read the head segment into value and note its version, keeping a copy
+     * if cacheHead. Returns false if it doesn't exist.
+     */
+    bool readHead(Buffer* value) {
+      char key[key_size];
+      memset(key, 0, key_size);
+      sprintf(key, "%d", 0); 
+      bool exists;
+      client->read(tableId, key, key_size, value, NULL, &headVersion, &exists);
+      if (!exists) {
+        printf("ERROR: Head segment does not exist\n");
+        return false;
+      } 
+
+      if (cacheHead) {
+        const char* bytes = (const char*)value->getRange(0, value->size());
+        head.assign(bytes, bytes + value->size());
+        headCached = true;
+      }
+      return true;
+    }
+
+    /**
+     * Walk the list, visiting every element, and print the number and size
+     * of the elements in every segment if verbose. Returns the number of
+     * elements in the list.
+     */
+    uint64_t check(bool verbose = true) {
+      // Check the list
+      char key[key_size];
+      memset(key, 0, key_size);
+      sprintf(key, "%d", 0); 
       bool exists;
       Buffer value;
       client->read(tableId, key, key_size, &value, NULL, NULL, &exists);
       if (!exists) {
         printf("ERROR: Head segment does not exist\n");
-        return;
+        return 0;
       } 
 
       char* headSeg = (char*)value.getRange(0, value.size());
       uint32_t numTailSegs = *value.getOffset<uint32_t>(0);
-      uint32_t newHeadSegSize = value.size() + sizeof(uint32_t) + size;
+      uint64_t total = 0;
 
-      if (newHeadSegSize - sizeof(uint32_t) > head_segment_size) {
-        // Split!
-        // Write new empty head seg with updated metadata.
-        char newHeadSeg[sizeof(uint32_t)];
-        numTailSegs++;
-        memcpy(newHeadSeg, &numTailSegs, sizeof(uint32_t));
-        client->write(tableId, key, key_size, newHeadSeg, sizeof(uint32_t));
+      if (verbose) {
+        printf("List contains %d tail segments\n", numTailSegs);
+        printf("Head Segment Contents:\n");
+      }
+      uint64_t bytes = 0;
+      uint32_t count = walkSegment(&value, sizeof(uint32_t), &bytes);
+      total += count;
+
+      if (verbose)
+        printf("\tSeg has %d elements (%lu bytes)\n", count, bytes);
 
-        // Write new tail segment
+      for (int i = numTailSegs; i > 0; i--) {
         memset(key, 0, key_size);
-        sprintf(key, "%d", numTailSegs);
+        sprintf(key, "%d", i); 
+        bool exists;
+        Buffer value;
+        client->read(tableId, key, key_size, &value, NULL, NULL, &exists);
+        if (!exists) {
+          printf("ERROR: Tail segment %d does not exist\n", i);
+          return total;
+        } 
 
-        uint32_t newTailSegSize = newHeadSegSize - sizeof(uint32_t);
-        char newTailSeg[newTailSegSize];
+        if (verbose)
+          printf("Tail Segment %d Contents:\n", i);
+        uint64_t bytes = 0;
+        uint32_t count = walkSegment(&value, 0, &bytes);
+        total += count;
 
-        uint32_t offset = 0;
-        // Insert the new value at the front
-        memcpy(newTailSeg + offset, &size, sizeof(uint32_t));
+        if (verbose)
+          printf("\tSeg has %d elements (%lu bytes)\n", count, bytes);
+      }
+
+      return total;
+    }
+
+    /**
+     * Read segment seg (0 for the head segment) into value. Returns false
+     * if it doesn't exist.
+     */
+    bool readSegment(uint32_t seg, Buffer* value) {
+      char key[key_size];
+      memset(key, 0, key_size);
+      sprintf(key, "%d", seg); 
+      bool exists;
+      client->read(tableId, key, key_size, value, NULL, NULL, &exists);
+      return exists;
+    }
+
+    /**
+     * Return the number of elements in a segment read by readSegment().
+     */
+    uint32_t countElements(uint32_t seg, Buffer* value) {
+      uint32_t start = (seg == 0) ? sizeof(uint32_t) : 0;
+      return countSegment((const char*)value->getRange(0, value->size()),
+          value->size(), start);
+    }
+
+    /**
+     * Read the index'th element, in storage order, of segment seg. Returns
+     * a pointer to the element in value and sets size, or returns NULL if
+     * there is no such element.
+     */
+    const char* readElement(uint32_t seg, uint32_t index, Buffer* value,
+        uint32_t* size) {
+      if (!readSegment(seg, value))
+        return NULL;
+      uint32_t start = (seg == 0) ? sizeof(uint32_t) : 0;
+
+      uint32_t offset;
+      if (layout == TAIL_APPEND) {
+        uint32_t count =
+            *value->getOffset<uint32_t>(value->size() - sizeof(uint32_t));
+        if (index >= count)
+          return NULL;
+        uint32_t footer = value->size() - (count + 1) * sizeof(uint32_t);
+        offset = start +
+            *value->getOffset<uint32_t>(footer + index * sizeof(uint32_t));
+      } else {
+        offset = start;
+        for (uint32_t i = 0; i < index; i++) {
+          if (offset >= value->size())
+            return NULL;
+          offset += sizeof(uint32_t) + *value->getOffset<uint32_t>(offset);
+        }
+        if (offset >= value->size())
+          return NULL;
+      }
+
+      *size = *value->getOffset<uint32_t>(offset);
+      return value->getOffset<char>(offset + sizeof(uint32_t));
+    }
+
+    /**
+     * Visit every element of the list: those of the head segment, then
+     * those of the tail segments from the newest to the oldest, each
+     * segment's in storage order. visit(const char* element, uint32_t size)
+     * gets a pointer into the segment as it was received from the server,
+     * which is only valid during the call. Returns the number of elements.
+     *
+     * Once the head segment has given the number of tail segments, the tail
+     * segments are fetched by multiReads of up to chunkSize segments, with
+     * up to pipelineDepth of them outstanding. Chunks are decoded in the
+     * order they were requested while the later ones are still in flight.
+     */
+    template<typename Visitor>
+    uint64_t readAll(Visitor visit, uint32_t chunkSize = 32,
+        uint32_t pipelineDepth = 4) {
+      Buffer value;
+      if (!readSegment(0, &value)) {
+        printf("ERROR: Head segment does not exist\n");
+        return 0;
+      }
+      uint32_t numTailSegs = *value.getOffset<uint32_t>(0);
+      uint64_t total = visitSegment(
+          (const char*)value.getRange(0, value.size()), value.size(),
+          sizeof(uint32_t), visit);
+
+      // Chunk slot s uses entries [s * chunkSize, (s + 1) * chunkSize).
+      uint32_t entries = pipelineDepth * chunkSize;
+      std::vector<char> keys(entries * key_size);
+      std::vector<Tub<ObjectBuffer>> values(entries);
+      std::vector<MultiReadObject> objects(entries);
+      std::vector<MultiReadObject*> requests(entries);
+      std::vector<Tub<MultiRead>> rpcs(pipelineDepth);
+      // First (newest) segment of the chunk in each slot and its size.
+      std::vector<uint32_t> firstSegs(pipelineDepth);
+      std::vector<uint32_t> chunkSegs(pipelineDepth);
+
+      uint32_t nextSeg = numTailSegs;
+      uint32_t issued = 0;
+      uint32_t retired = 0;
+      while (retired < issued || nextSeg > 0) {
+        while (nextSeg > 0 && issued - retired < pipelineDepth) {
+          uint32_t slot = issued % pipelineDepth;
+          uint32_t count = std::min(chunkSize, nextSeg);
+          for (uint32_t i = 0; i < count; i++) {
+            uint32_t e = slot * chunkSize + i;
+            char* key = &keys[e * key_size];
+            memset(key, 0, key_size);
+            sprintf(key, "%d", nextSeg - i);
+            values[e].destroy();
+            objects[e] = MultiReadObject(tableId, key, key_size, &values[e]);
+            requests[e] = &objects[e];
+          }
+
+          rpcs[slot].construct(client, &requests[slot * chunkSize], count);
+          firstSegs[slot] = nextSeg;
+          chunkSegs[slot] = count;
+          nextSeg -= count;
+          issued++;
+        }
+
+        uint32_t slot = retired % pipelineDepth;
+        rpcs[slot]->wait();
+        for (uint32_t i = 0; i < chunkSegs[slot]; i++) {
+          uint32_t e = slot * chunkSize + i;
+          if (!values[e]) {
+            printf("ERROR: Tail segment %d does not exist\n",
+                firstSegs[slot] - i);
+            continue;
+          }
+
+          uint32_t size;
+          const char* seg = (const char*)values[e]->getValue(&size);
+          total += visitSegment(seg, size, 0, visit);
+        }
+        rpcs[slot].destroy();
+        retired++;
+      }
+
+      return total;
+    }
+
+    /**
+     * Visit the elements at positions [first, last) of the list, oldest
+     * first, the same way readAll() does. Returns the number of elements
+     * visited, which is less than last - first if the list is shorter.
+     *
+     * The head segment and the index are fetched by one multiRead, and the
+     * tail segments holding the range by a second one. Returns 0 if a tail
+     * segment isn't indexed yet.
+     */
+    template<typename Visitor>
+    uint64_t range(uint64_t first, uint64_t last, Visitor visit) {
+      char headKey[key_size];
+      memset(headKey, 0, key_size);
+      sprintf(headKey, "%d", 0); 
+      char indexKey[key_size];
+      memset(indexKey, 0, key_size);
+      sprintf(indexKey, "index"); 
+
+      Tub<ObjectBuffer> headValue;
+      Tub<ObjectBuffer> indexValue;
+      MultiReadObject headObject(tableId, headKey, key_size, &headValue);
+      MultiReadObject indexObject(tableId, indexKey, key_size, &indexValue);
+      MultiReadObject* metadata[] = {&headObject, &indexObject};
+      client->multiRead(metadata, 2);
+      if (!headValue || !indexValue) {
+        printf("ERROR: Head segment or index does not exist\n");
+        return 0;
+      }
+
+      uint32_t headSize;
+      const char* headSeg = (const char*)headValue->getValue(&headSize);
+      uint32_t numTailSegs = *(const uint32_t*)headSeg;
+      uint32_t indexSize;
+      const uint32_t* counts =
+          (const uint32_t*)indexValue->getValue(&indexSize);
+
+      // Position of the first element of tail segment i + 1, and of the
+      // head segment's (i = numTailSegs).
+      std::vector<uint64_t> starts(numTailSegs + 1);
+      uint64_t position = 0;
+      for (uint32_t i = 0; i < numTailSegs; i++) {
+        if ((i + 1) * sizeof(uint32_t) > indexSize || counts[i] == 0) {
+          printf("ERROR: Tail segment %d is not indexed\n", i + 1);
+          return 0;
+        }
+        starts[i] = position;
+        position += counts[i];
+      }
+      starts[numTailSegs] = position;
+      uint32_t headCount = countSegment(headSeg, headSize, sizeof(uint32_t));
+
+      last = std::min(last, position + headCount);
+      if (first >= last)
+        return 0;
+      uint32_t firstSeg = std::upper_bound(starts.begin(), starts.end(),
+          first) - starts.begin() - 1;
+      uint32_t lastSeg = std::upper_bound(starts.begin(), starts.end(),
+          last - 1) - starts.begin() - 1;
+
+      // Fetch the tail segments in the range.
+      uint32_t fetched = std::min(lastSeg + 1, numTailSegs);
+      fetched = (fetched > firstSeg) ? fetched - firstSeg : 0;
+      std::vector<char> keys(fetched * key_size);
+      std::vector<Tub<ObjectBuffer>> values(fetched);
+      std::vector<MultiReadObject> objects(fetched);
+      std::vector<MultiReadObject*> requests(fetched);
+      for (uint32_t i = 0; i < fetched; i++) {
+        char* key = &keys[i * key_size];
+        memset(key, 0, key_size);
+        sprintf(key, "%d", firstSeg + i + 1);
+        objects[i] = MultiReadObject(tableId, key, key_size, &values[i]);
+        requests[i] = &objects[i];
+      }
+      if (fetched > 0)
+        client->multiRead(&requests[0], fetched);
+
+      uint64_t visited = 0;
+      for (uint32_t i = firstSeg; i <= lastSeg; i++) {
+        const char* seg = headSeg;
+        uint32_t segSize = headSize;
+        uint32_t start = sizeof(uint32_t);
+        uint32_t count = headCount;
+        if (i < numTailSegs) {
+          if (!values[i - firstSeg]) {
+            printf("ERROR: Tail segment %d does not exist\n", i + 1);
+            return visited;
+          }
+          seg = (const char*)values[i - firstSeg]->getValue(&segSize);
+          start = 0;
+          count = counts[i];
+        }
+
+        uint32_t from = std::max(first, starts[i]) - starts[i];
+        uint32_t to = std::min(last, starts[i] + count) - starts[i];
+        visitOldestFirst(seg, segSize, start, count, from, to, visit);
+        visited += to - from;
+      }
+
+      return visited;
+    }
+
+    /**
+     * Visit the element at a position of the list (see range()). Returns
+     * false if there is no such element.
+     */
+    template<typename Visitor>
+    bool get(uint64_t position, Visitor visit) {
+      return range(position, position + 1, visit) == 1;
+    }
+
+  PRIVATE:
+    /**
+     * Call visit on every element of a segment held in seg, whose elements
+     * start at byte start, in storage order. Returns the number of
+     * elements.
+     */
+    template<typename Visitor>
+    uint32_t visitSegment(const char* seg, uint32_t segSize, uint32_t start,
+        Visitor& visit) {
+      if (layout == TAIL_APPEND) {
+        uint32_t numElements =
+            *(const uint32_t*)(seg + segSize - sizeof(uint32_t));
+        const uint32_t* offsets = (const uint32_t*)(seg + segSize -
+            (numElements + 1) * sizeof(uint32_t));
+        for (uint32_t i = 0; i < numElements; i++) {
+          const char* element = seg + start + offsets[i];
+          visit(element + sizeof(uint32_t), *(const uint32_t*)element);
+        }
+        return numElements;
+      }
+
+      uint32_t offset = start;
+      uint32_t count = 0;
+      while (offset < segSize) {
+        uint32_t size = *(const uint32_t*)(seg + offset);
         offset += sizeof(uint32_t);
-        memcpy(newTailSeg + offset, data, size);
+        visit(seg + offset, size);
         offset += size;
-        // Put the original data at the end
-        memcpy(newTailSeg + offset, headSeg + sizeof(uint32_t), value.size() - sizeof(uint32_t));
-        client->write(tableId, key, key_size, newTailSeg, newTailSegSize);
+        count++;
+      }
+      return count;
+    }
+
+    /**
+     * Return the number of elements in a segment held in seg, whose
+     * elements start at byte start.
+     */
+    uint32_t countSegment(const char* seg, uint32_t segSize, uint32_t start) {
+      if (layout == TAIL_APPEND)
+        return *(const uint32_t*)(seg + segSize - sizeof(uint32_t));
+
+      uint32_t offset = start;
+      uint32_t count = 0;
+      while (offset < segSize) {
+        offset += sizeof(uint32_t) + *(const uint32_t*)(seg + offset);
+        count++;
+      }
+      return count;
+    }
+
+    /**
+     * Call visit on the elements [from, to) of a segment held in seg, whose
+     * count elements start at byte start, numbering them and visiting them
+     * from the oldest.
+     */
+    template<typename Visitor>
+    void visitOldestFirst(const char* seg, uint32_t segSize, uint32_t start,
+        uint32_t count, uint32_t from, uint32_t to, Visitor& visit) {
+      if (layout == TAIL_APPEND) {
+        const uint32_t* offsets = (const uint32_t*)(seg + segSize -
+            (count + 1) * sizeof(uint32_t));
+        for (uint32_t i = from; i < to; i++) {
+          const char* element = seg + start + offsets[i];
+          visit(element + sizeof(uint32_t), *(const uint32_t*)element);
+        }
+        return;
+      }
+
+      // Stored newest first: element i is the (count - 1 - i)'th. Walk up
+      // to the oldest one wanted, then visit them backwards.
+      std::vector<const char*> elements(to - from);
+      uint32_t offset = start;
+      for (uint32_t s = 0; s < count - from; s++) {
+        if (s >= count - to)
+          elements[count - 1 - s - from] = seg + offset;
+        offset += sizeof(uint32_t) + *(const uint32_t*)(seg + offset);
+      }
+      for (uint32_t i = 0; i < elements.size(); i++) {
+        visit(elements[i] + sizeof(uint32_t),
+            *(const uint32_t*)elements[i]);
+      }
+    }
+
+    /**
+     * Visit every element of a segment read into value, whose elements
+     * start at byte start, in storage order, adding their sizes to bytes.
+     * Returns the number of elements.
+     */
+    uint32_t walkSegment(Buffer* value, uint32_t start, uint64_t* bytes) {
+      auto touch = [bytes](const char* element, uint32_t size) {
+        *bytes += size;
+      };
+      return visitSegment((const char*)value->getRange(0, value->size()),
+          value->size(), start, touch);
+    }
+
+    /**
+     * Add an element to the end of a TAIL_APPEND segment held in seg, whose
+     * elements start at byte start: the element goes between the old
+     * elements and the footer, which moves back to make room and gains the
+     * element's offset.
+     */
+    void appendToSegment(std::vector<char>* seg, uint32_t start, char* data,
+        uint32_t size) {
+      uint32_t oldSize = seg->size();
+      uint32_t count;
+      memcpy(&count, &(*seg)[oldSize - sizeof(uint32_t)], sizeof(uint32_t));
+      uint32_t footer = oldSize - (count + 1) * sizeof(uint32_t);
+
+      seg->resize(oldSize + 2 * sizeof(uint32_t) + size);
+      char* p = &(*seg)[0];
+      // Move the offsets back
+      uint32_t newFooter = footer + sizeof(uint32_t) + size;
+      memmove(p + newFooter, p + footer, count * sizeof(uint32_t));
+      // Insert the new value at the end of the elements
+      memcpy(p + footer, &size, sizeof(uint32_t));
+      memcpy(p + footer + sizeof(uint32_t), data, size);
+      uint32_t offset = footer - start;
+      memcpy(p + newFooter + count * sizeof(uint32_t), &offset, sizeof(uint32_t));
+      count++;
+      memcpy(p + newFooter + count * sizeof(uint32_t), &count, sizeof(uint32_t));
+    }
+
+    /**
+     * Write the new contents of the list given the current head segment.
+     * Returns false, having written nothing, if the head segment has
+     * changed since it was read.
+     */
+    bool appendToHead(char* key, const char* headSeg, uint32_t headSegSize,
+        char* data, uint32_t size) {
+      uint64_t buildStart = Cycles::rdtsc();
+      uint32_t numTailSegs = *(const uint32_t*)headSeg;
+      uint32_t newHeadSegSize = headSegSize + sizeof(uint32_t) + size;
+      if (layout == TAIL_APPEND)
+        newHeadSegSize += sizeof(uint32_t);
+
+      if (newHeadSegSize - sizeof(uint32_t) > head_segment_size) {
+        // Split!
+        uint32_t newTailSegSize = newHeadSegSize - sizeof(uint32_t);
+        uint32_t newTailCount =
+            countSegment(headSeg, headSegSize, sizeof(uint32_t)) + 1;
+        if (layout == TAIL_APPEND) {
+          newTail.assign(headSeg + sizeof(uint32_t), headSeg + headSegSize);
+          appendToSegment(&newTail, 0, data, size);
+        } else {
+          newTail.resize(newTailSegSize);
+          char* newTailSeg = &newTail[0];
+
+          uint32_t offset = 0;
+          // Insert the new value at the front
+          memcpy(newTailSeg + offset, &size, sizeof(uint32_t));
+          offset += sizeof(uint32_t);
+          memcpy(newTailSeg + offset, data, size);
+          offset += size;
+          // Put the original data at the end
+          memcpy(newTailSeg + offset, headSeg + sizeof(uint32_t), headSegSize - sizeof(uint32_t));
+        }
+
+        // New empty head seg with updated metadata.
+        numTailSegs++;
+        newHead.assign((layout == TAIL_APPEND) ? 2 * sizeof(uint32_t) :
+            sizeof(uint32_t), 0);
+        memcpy(&newHead[0], &numTailSegs, sizeof(uint32_t));
+
+        char tailKey[key_size];
+        memset(tailKey, 0, key_size);
+        sprintf(tailKey, "%d", numTailSegs);
+        buildCycles += Cycles::rdtsc() - buildStart;
+
+        if (transactionalSplits) {
+          if (!splitInTransaction(key, headSeg, headSegSize, tailKey,
+              numTailSegs, newTailCount))
+            return false;
+        } else {
+          if (!writeHead(key, &headVersion))
+            return false;
+          client->write(tableId, tailKey, key_size, &newTail[0], newTailSegSize);
+          indexSegment(numTailSegs, newTailCount);
+        }
+        splits++;
+      } else if (layout == TAIL_APPEND) {
+        // No split. The cached head segment is extended in place; if the
+        // write is rejected the cache is read again anyway.
+        if (cacheHead && headSeg == &head[0])
+          newHead.swap(head);
+        else
+          newHead.assign(headSeg, headSeg + headSegSize);
+        appendToSegment(&newHead, sizeof(uint32_t), data, size);
+        buildCycles += Cycles::rdtsc() - buildStart;
+
+        if (!writeHead(key, &headVersion))
+          return false;
       } else {
         // No split
-        char newHeadSeg[newHeadSegSize];
+        newHead.resize(newHeadSegSize);
+        char* newHeadSeg = &newHead[0];
         uint32_t offset = 0;
         // Copy the head segment meta data portion
         memcpy(newHeadSeg + offset, headSeg, sizeof(uint32_t));
@@ -112,67 +719,160 @@ class List {
         memcpy(newHeadSeg + offset, data, size);
         offset += size;
         // Put the original data at the end
-        memcpy(newHeadSeg + offset, headSeg + sizeof(uint32_t), value.size() - sizeof(uint32_t));
-        client->write(tableId, key, key_size, newHeadSeg, newHeadSegSize);
+        memcpy(newHeadSeg + offset, headSeg + sizeof(uint32_t), headSegSize - sizeof(uint32_t));
+        buildCycles += Cycles::rdtsc() - buildStart;
+
+        if (!writeHead(key, &headVersion))
+          return false;
       }
+      return true;
     }
 
-    void check() {
-      // Check the list
-      char key[key_size];
-      memset(key, 0, key_size);
-      sprintf(key, "%d", 0); 
-      bool exists;
-      Buffer value;
-      client->read(tableId, key, key_size, &value, NULL, NULL, &exists);
-      if (!exists) {
-        printf("ERROR: Head segment does not exist\n");
-        return;
-      } 
+    /**
+     * Write newHead as the head segment, rejecting the write if the head
+     * segment is no longer at expectedVersion (if given). Returns false if
+     * rejected. When caching, newHead becomes the cached head segment.
+     */
+    bool writeHead(char* key, const uint64_t* expectedVersion) {
+      RejectRules rejectRules;
+      memset(&rejectRules, 0, sizeof(rejectRules));
+      if (expectedVersion != NULL) {
+        rejectRules.givenVersion = *expectedVersion;
+        rejectRules.doesntExist = true;
+        rejectRules.versionNeGiven = true;
+      }
 
-      char* headSeg = (char*)value.getRange(0, value.size());
-      uint32_t numTailSegs = *value.getOffset<uint32_t>(0);
+      try {
+        client->write(tableId, key, key_size, &newHead[0], newHead.size(),
+            &rejectRules, &headVersion);
+      } catch (ObjectVersionDoesntMatchException& e) {
+        return false;
+      }
 
-      printf("List contains %d tail segments\n", numTailSegs);
+      if (cacheHead) {
+        // The old cache becomes the next append's scratch space.
+        head.swap(newHead);
+        headCached = true;
+      }
+      return true;
+    }
 
-      printf("Head Segment Contents:\n");
-      uint32_t offset = sizeof(uint32_t);
-      uint32_t count = 0;
-      while(offset < value.size()) {
-        uint32_t size = *value.getOffset<uint32_t>(offset);
-        offset += sizeof(uint32_t);
-        char* element = value.getOffset<char>(offset);
-        offset += size;
-        count++;
+    /**
+     * Write a split's head and tail segments (newHead and newTail) and index
+     * tail segment seg, holding count elements, in one transaction, which
+     * commits only if the head segment still holds headSeg. Returns false
+     * if it doesn't.
+     */
+    bool splitInTransaction(char* key, const char* headSeg,
+        uint32_t headSegSize, char* tailKey, uint32_t seg, uint32_t count) {
+      Transaction transaction(client);
+      Buffer current;
+      transaction.read(tableId, key, key_size, &current);
+      if (current.size() != headSegSize ||
+          memcmp(current.getRange(0, headSegSize), headSeg, headSegSize) != 0)
+        return false;
+
+      char indexKey[key_size];
+      memset(indexKey, 0, key_size);
+      sprintf(indexKey, "index"); 
+      Buffer index;
+      transaction.read(tableId, indexKey, key_size, &index);
+      loadSegCounts(&index);
+      setSegCount(seg, count);
+
+      transaction.write(tableId, key, key_size, &newHead[0], newHead.size());
+      transaction.write(tableId, tailKey, key_size, &newTail[0], newTail.size());
+      transaction.write(tableId, indexKey, key_size, segCounts.data(),
+          segCounts.size() * sizeof(uint32_t));
+      if (!transaction.commit()) {
+        aborts++;
+        return false;
       }
 
-      printf("\tSeg has %d elements\n", count);
+      // The transaction doesn't return the new versions.
+      headCached = false;
+      segCountsCached = false;
+      return true;
+    }
 
-      for (int i = numTailSegs; i > 0; i--) {
-        memset(key, 0, key_size);
-        sprintf(key, "%d", i); 
-        bool exists;
-        Buffer value;
-        client->read(tableId, key, key_size, &value, NULL, NULL, &exists);
-        if (!exists) {
-          printf("ERROR: Tail segment %d does not exist\n", i);
-          return;
-        } 
+    /**
+     * Record in the index that tail segment seg holds count elements,
+     * writing the index on the condition that it hasn't changed since it
+     * was read, and starting over if it has. With a single appender the
+     * index stays cached and is not read again.
+     */
+    void indexSegment(uint32_t seg, uint32_t count) {
+      char key[key_size];
+      memset(key, 0, key_size);
+      sprintf(key, "index"); 
 
-        printf("Tail Segment %d Contents:\n", i);
-        uint32_t offset = 0;
-        uint32_t count = 0;
-        while(offset < value.size()) {
-          uint32_t size = *value.getOffset<uint32_t>(offset);
-          offset += sizeof(uint32_t);
-          char* element = value.getOffset<char>(offset);
-          offset += size;
-          count++;
+      while (true) {
+        if (!segCountsCached) {
+          bool exists;
+          Buffer value;
+          client->read(tableId, key, key_size, &value, NULL, &segCountsVersion, &exists);
+          if (!exists) {
+            printf("ERROR: Index does not exist\n");
+            return;
+          } 
+          loadSegCounts(&value);
         }
+        setSegCount(seg, count);
 
-        printf("\tSeg has %d elements\n", count);
+        RejectRules rejectRules;
+        memset(&rejectRules, 0, sizeof(rejectRules));
+        rejectRules.givenVersion = segCountsVersion;
+        rejectRules.doesntExist = true;
+        rejectRules.versionNeGiven = true;
+        try {
+          client->write(tableId, key, key_size, segCounts.data(),
+              segCounts.size() * sizeof(uint32_t), &rejectRules,
+              &segCountsVersion);
+          segCountsCached = true;
+          return;
+        } catch (ObjectVersionDoesntMatchException& e) {
+          segCountsCached = false;
+        }
       }
     }
+
+    /**
+     * Replace segCounts with the contents of the index read into value.
+     */
+    void loadSegCounts(Buffer* value) {
+      segCounts.resize(value->size() / sizeof(uint32_t));
+      if (value->size() > 0)
+        memcpy(segCounts.data(), value->getRange(0, value->size()),
+            value->size());
+    }
+
+    /**
+     * Set the count of tail segment seg in segCounts, growing it if needed.
+     * Segments whose splits haven't indexed them yet are left at 0.
+     */
+    void setSegCount(uint32_t seg, uint32_t count) {
+      if (segCounts.size() < seg)
+        segCounts.resize(seg, 0);
+      segCounts[seg - 1] = count;
+    }
+
+    /// Copy of the head segment, if cacheHead.
+    std::vector<char> head;
+    /// Version of the head segment last read or written.
+    uint64_t headVersion;
+    /// True if head holds the current head segment.
+    bool headCached;
+
+    /// Buffers the new head and tail segments of an append are built in.
+    std::vector<char> newHead;
+    std::vector<char> newTail;
+
+    /// Copy of the index, or the index being built by a split.
+    std::vector<uint32_t> segCounts;
+    /// Version of the index last read or written.
+    uint64_t segCountsVersion;
+    /// True if segCounts holds the current index.
+    bool segCountsCached;
 };
 
 int
@@ -236,6 +936,21 @@ try
     uint32_t head_segment_points = 1;
     std::string head_segment_points_mode = "linear";
     uint32_t samples_per_point = 1000;
+    uint32_t histogram_precision = 3;
+    std::string head_cache = "off";
+    uint32_t appenders_range_start = 1;
+    uint32_t appenders_range_end = 1;
+    uint32_t appenders_points = 1;
+    std::string appenders_points_mode = "linear";
+    std::string split_mode = "conditional";
+    uint32_t list_length_range_start = 1000;
+    uint32_t list_length_range_end = 1000;
+    uint32_t list_length_points = 1;
+    std::string list_length_points_mode = "linear";
+    std::string list_layout = "front";
+    uint32_t multi_size = 32;
+    uint32_t pipeline_depth = 4;
+    uint32_t range_size = 100;
 
     std::ifstream cfgFile(configFilename);
     std::string line;
@@ -296,6 +1011,107 @@ try
             std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
             uint32_t var_int_value = std::stoi(var_value);
             samples_per_point = var_int_value;
+          } else if (var_name.compare("histogram_precision") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+
+            if (var_int_value < 1 || var_int_value > 5) {
+              printf("ERROR: histogram_precision must be between 1 and 5: %d\n", var_int_value);
+              return 1;
+            }
+
+            histogram_precision = var_int_value;
+          } else if (var_name.compare("head_cache") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+
+            if (var_value.compare("off") != 0 &&
+                var_value.compare("on") != 0 &&
+                var_value.compare("both") != 0) {
+              printf("ERROR: head_cache must be off, on or both: %s\n", var_value.c_str());
+              return 1;
+            }
+
+            head_cache = var_value;
+          } else if (var_name.compare("appenders_range_start") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            appenders_range_start = var_int_value;
+          } else if (var_name.compare("appenders_range_end") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            appenders_range_end = var_int_value;
+          } else if (var_name.compare("appenders_points") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            appenders_points = var_int_value;
+          } else if (var_name.compare("appenders_points_mode") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            appenders_points_mode = var_value;
+          } else if (var_name.compare("split_mode") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+
+            if (var_value.compare("conditional") != 0 &&
+                var_value.compare("transaction") != 0) {
+              printf("ERROR: split_mode must be conditional or transaction: %s\n", var_value.c_str());
+              return 1;
+            }
+
+            split_mode = var_value;
+          } else if (var_name.compare("list_length_range_start") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            list_length_range_start = var_int_value;
+          } else if (var_name.compare("list_length_range_end") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            list_length_range_end = var_int_value;
+          } else if (var_name.compare("list_length_points") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            list_length_points = var_int_value;
+          } else if (var_name.compare("list_length_points_mode") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            list_length_points_mode = var_value;
+          } else if (var_name.compare("list_layout") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+
+            if (var_value.compare("front") != 0 &&
+                var_value.compare("tail") != 0) {
+              printf("ERROR: list_layout must be front or tail: %s\n", var_value.c_str());
+              return 1;
+            }
+
+            list_layout = var_value;
+          } else if (var_name.compare("multi_size") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+
+            if (var_int_value < 1) {
+              printf("ERROR: multi_size must be at least 1: %d\n", var_int_value);
+              return 1;
+            }
+
+            multi_size = var_int_value;
+          } else if (var_name.compare("pipeline_depth") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+
+            if (var_int_value < 1) {
+              printf("ERROR: pipeline_depth must be at least 1: %d\n", var_int_value);
+              return 1;
+            }
+
+            pipeline_depth = var_int_value;
+          } else if (var_name.compare("range_size") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+
+            if (var_int_value < 1) {
+              printf("ERROR: range_size must be at least 1: %d\n", var_int_value);
+              return 1;
+            }
+
+            range_size = var_int_value;
           } else {
             printf("ERROR: Unknown parameter: %s\n", var_name.c_str());
             return 1;
@@ -310,6 +1126,8 @@ try
 
       std::vector<uint32_t> element_sizes; 
       std::vector<uint32_t> head_segment_sizes; 
+      std::vector<uint32_t> appender_counts; 
+      std::vector<uint32_t> list_lengths; 
 
       if (element_points > 1) {
         if (element_points_mode.compare("linear") == 0) {
@@ -349,6 +1167,44 @@ try
         head_segment_sizes.push_back(head_segment_range_start);
       }
 
+      if (appenders_points > 1) {
+        if (appenders_points_mode.compare("linear") == 0) {
+          uint32_t step_size = 
+            (appenders_range_end - appenders_range_start) / (appenders_points - 1);
+
+          for (int i = appenders_range_start; i <= appenders_range_end; i += step_size) 
+            appender_counts.push_back(i);
+        } else if (appenders_points_mode.compare("geometric") == 0) {
+          double c = pow(10, log10((double)appenders_range_end/(double)appenders_range_start) / (double)(appenders_points - 1));
+          for (int i = appenders_range_start; i <= appenders_range_end; i *= c)
+            appender_counts.push_back(i);
+        } else {
+          printf("ERROR: Unknown points mode: %s\n", appenders_points_mode.c_str());
+          return 1;
+        }
+      } else {
+        appender_counts.push_back(appenders_range_start);
+      }
+
+      if (list_length_points > 1) {
+        if (list_length_points_mode.compare("linear") == 0) {
+          uint32_t step_size = 
+            (list_length_range_end - list_length_range_start) / (list_length_points - 1);
+
+          for (int i = list_length_range_start; i <= list_length_range_end; i += step_size) 
+            list_lengths.push_back(i);
+        } else if (list_length_points_mode.compare("geometric") == 0) {
+          double c = pow(10, log10((double)list_length_range_end/(double)list_length_range_start) / (double)(list_length_points - 1));
+          for (int i = list_length_range_start; i <= list_length_range_end; i *= c)
+            list_lengths.push_back(i);
+        } else {
+          printf("ERROR: Unknown points mode: %s\n", list_length_points_mode.c_str());
+          return 1;
+        }
+      } else {
+        list_lengths.push_back(list_length_range_start);
+      }
+
       if (op.compare("append") == 0) {
         uint64_t tableId = client.createTable("test");
 
@@ -360,68 +1216,478 @@ try
           char filename[128];
           sprintf(filename, "append.spp_%d.es_%d.csv", samples_per_point, element_size);
           datFile = fopen(filename, "w");
-          fprintf(datFile, "%12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s\n", 
+          fprintf(datFile, "%12s %12s %12s %12s", 
               "SegSize",
+              "Cached",
               "Avg",
-              "1th",
-              "2th",
-              "5th",
-              "10th",
-              "25th",
-              "50th",
-              "75th",
-              "90th",
-              "95th",
-              "98th",
-              "99th");
+              "BuildCycles");
+          LatencyHistogram::printHeader(datFile);
+          fprintf(datFile, "\n");
+
+          // Which append paths to run at every point.
+          std::vector<bool> cache_modes;
+          if (head_cache.compare("on") != 0)
+            cache_modes.push_back(false);
+          if (head_cache.compare("off") != 0)
+            cache_modes.push_back(true);
 
           for (int hs_idx = 0; hs_idx < head_segment_sizes.size(); hs_idx++) {
             uint32_t head_segment_size = head_segment_sizes[hs_idx];
-            printf("Append Test: element_size: %dB, head_segment_size: %dB\n", element_size, head_segment_size);
+
+            for (int hc_idx = 0; hc_idx < cache_modes.size(); hc_idx++) {
+              bool cached = cache_modes[hc_idx];
+              printf("Append Test: element_size: %dB, head_segment_size: %dB, cached: %d\n", element_size, head_segment_size, cached);
             
-            List list(&client, tableId, head_segment_size);
+              List list(&client, tableId, head_segment_size, cached);
 
-            char element[element_size];
+              char element[element_size];
+
+              LatencyHistogram latencyHist(histogram_precision);
+              for (int i = 0; i < samples_per_point; i++) {
+                uint64_t start = Cycles::rdtsc();
+                list.append(element, element_size);
+                uint64_t end = Cycles::rdtsc();
+                latencyHist.record(Cycles::toNanoseconds(end-start));
+              }
+
+              // Client cycles spent building segments, per append.
+              fprintf(datFile, "%12d %12d %12.1f %12.0f", 
+                  head_segment_size,
+                  cached,
+                  latencyHist.getMean() / 1000.0,
+                  (double)list.buildCycles / samples_per_point);
+              latencyHist.printPercentiles(datFile, 1000.0, 1);
+              fprintf(datFile, "\n");
+              fflush(datFile);
+            }
+          }
+
+          fclose(datFile);
+        }
+
+        client.dropTable("test");
+      } else if (op.compare("concurrent_append") == 0) {
+        uint64_t tableId = client.createTable("test");
+        bool transactional = (split_mode.compare("transaction") == 0);
+
+        for (int es_idx = 0; es_idx < element_sizes.size(); es_idx++) {
+          uint32_t element_size = element_sizes[es_idx];
+
+          // Open data file for writing.
+          FILE * datFile;
+          char filename[128];
+          sprintf(filename, "concurrent_append.spp_%d.es_%d.sm_%s.csv", samples_per_point, element_size, split_mode.c_str());
+          datFile = fopen(filename, "w");
+          fprintf(datFile, "%12s %12s %12s %12s", 
+              "SegSize",
+              "Appenders",
+              "Appends/s",
+              "Avg");
+          LatencyHistogram::printHeader(datFile);
+          fprintf(datFile, " %12s %12s %12s %12s\n", 
+              "Retries",
+              "Aborts",
+              "Splits",
+              "Lost");
+
+          for (int hs_idx = 0; hs_idx < head_segment_sizes.size(); hs_idx++) {
+            uint32_t head_segment_size = head_segment_sizes[hs_idx];
+
+            for (int ap_idx = 0; ap_idx < appender_counts.size(); ap_idx++) {
+              uint32_t appenders = appender_counts[ap_idx];
+              printf("Concurrent Append Test: element_size: %dB, head_segment_size: %dB, appenders: %d\n", element_size, head_segment_size, appenders);
+
+              // A fresh list, which every appender then opens on its own
+              // client.
+              List list(&client, tableId, head_segment_size);
+
+              // Each appender appends samples_per_point elements and keeps
+              // its own statistics.
+              std::vector<LatencyHistogram> threadHists(appenders,
+                  LatencyHistogram(histogram_precision));
+              std::vector<uint64_t> threadConflicts(appenders);
+              std::vector<uint64_t> threadAborts(appenders);
+              std::vector<uint64_t> threadSplits(appenders);
+              ClientThreads clientThreads(&client, &optionParser.options,
+                  appenders);
+              clientThreads.run([&](RamCloud* threadClient, uint32_t threadIndex) {
+                List threadList(threadClient, tableId, head_segment_size,
+                    true, false);
+                threadList.transactionalSplits = transactional;
+
+                char element[element_size];
+                memset(element, threadIndex, element_size);
+
+                // Untimed, so that locating the table's master and opening
+                // a session to it isn't part of the first append. This also
+                // fills the head cache.
+                Buffer headValue;
+                threadList.readHead(&headValue);
+
+                LatencyHistogram threadHist(histogram_precision);
+                clientThreads.start();
+                for (int i = 0; i < samples_per_point; i++) {
+                  uint64_t start = Cycles::rdtsc();
+                  threadList.append(element, element_size);
+                  uint64_t end = Cycles::rdtsc();
+                  threadHist.record(Cycles::toNanoseconds(end-start));
+                }
+                clientThreads.stop();
 
-            uint64_t latency[samples_per_point];
-            for (int i = 0; i < samples_per_point; i++) {
-              uint64_t start = Cycles::rdtsc();
-              list.append(element, element_size);
-              uint64_t end = Cycles::rdtsc();
-              latency[i] = Cycles::toNanoseconds(end-start);
+                threadHists[threadIndex] = threadHist;
+                threadConflicts[threadIndex] = threadList.conflicts;
+                threadAborts[threadIndex] = threadList.aborts;
+                threadSplits[threadIndex] = threadList.splits;
+              });
+
+              LatencyHistogram latencyHist(histogram_precision);
+              uint64_t conflicts = 0;
+              uint64_t aborts = 0;
+              uint64_t splits = 0;
+              for (int t = 0; t < appenders; t++) {
+                latencyHist.merge(threadHists[t]);
+                conflicts += threadConflicts[t];
+                aborts += threadAborts[t];
+                splits += threadSplits[t];
+              }
+
+              // Every append must have landed in the list.
+              uint64_t appends = (uint64_t)appenders * samples_per_point;
+              uint64_t found = list.check(false);
+              if (found != appends)
+                printf("ERROR: List holds %lu elements, expected %lu\n", found, appends);
+
+              fprintf(datFile, "%12d %12d %12.0f %12.1f", 
+                  head_segment_size,
+                  appenders,
+                  appends / clientThreads.getElapsedSeconds(),
+                  latencyHist.getMean() / 1000.0);
+              latencyHist.printPercentiles(datFile, 1000.0, 1);
+              fprintf(datFile, " %12lu %12lu %12lu %12ld\n", 
+                  conflicts,
+                  aborts,
+                  splits,
+                  (int64_t)(appends - found));
+              fflush(datFile);
             }
+          }
 
-            std::vector<uint64_t> latencyVec(latency, latency+samples_per_point);
+          fclose(datFile);
+        }
 
-            std::sort(latencyVec.begin(), latencyVec.end());
+        client.dropTable("test");
+      } else if (op.compare("layout") == 0) {
+        uint64_t tableId = client.createTable("test");
+
+        // Full scans are far slower than appends and point reads, so fewer
+        // are taken.
+        const uint32_t scans_per_point = 10;
+
+        for (int es_idx = 0; es_idx < element_sizes.size(); es_idx++) {
+          uint32_t element_size = element_sizes[es_idx];
+
+          // Open data file for writing.
+          FILE * datFile;
+          char filename[128];
+          sprintf(filename, "layout.spp_%d.es_%d.csv", samples_per_point, element_size);
+          datFile = fopen(filename, "w");
+          fprintf(datFile, "%12s %12s %12s %12s", 
+              "SegSize",
+              "Layout",
+              "Op",
+              "Avg");
+          LatencyHistogram::printHeader(datFile);
+          fprintf(datFile, " %12s\n", 
+              "Samples");
 
-            uint64_t sum = 0;
-            for (int i = 0; i < samples_per_point; i++) {
-              sum += latencyVec[i];
+          for (int hs_idx = 0; hs_idx < head_segment_sizes.size(); hs_idx++) {
+            uint32_t head_segment_size = head_segment_sizes[hs_idx];
+
+            for (int ly_idx = 0; ly_idx < 2; ly_idx++) {
+              List::Layout layout = (ly_idx == 0) ? List::FRONT_INSERT :
+                  List::TAIL_APPEND;
+              const char* layoutName = (ly_idx == 0) ? "front" : "tail";
+              printf("Layout Test: element_size: %dB, head_segment_size: %dB, layout: %s\n", element_size, head_segment_size, layoutName);
+
+              List list(&client, tableId, head_segment_size, true, true,
+                  layout);
+
+              char element[element_size];
+
+              // Append: builds a list of samples_per_point elements.
+              LatencyHistogram appendHist(histogram_precision);
+              for (int i = 0; i < samples_per_point; i++) {
+                uint64_t start = Cycles::rdtsc();
+                list.append(element, element_size);
+                uint64_t end = Cycles::rdtsc();
+                appendHist.record(Cycles::toNanoseconds(end-start));
+              }
+
+              // Element counts of the segments, to pick elements from.
+              Buffer headValue;
+              list.readSegment(0, &headValue);
+              uint32_t numTailSegs = *headValue.getOffset<uint32_t>(0);
+              std::vector<uint32_t> segs;
+              std::vector<uint32_t> counts;
+              for (uint32_t seg = 0; seg <= numTailSegs; seg++) {
+                Buffer value;
+                list.readSegment(seg, &value);
+                uint32_t count = list.countElements(seg, &value);
+                if (count > 0) {
+                  segs.push_back(seg);
+                  counts.push_back(count);
+                }
+              }
+
+              // Get: reads a uniformly chosen segment and finds a uniformly
+              // chosen element in it.
+              std::mt19937 generator(0);
+              LatencyHistogram getHist(histogram_precision);
+              for (int i = 0; i < samples_per_point; i++) {
+                uint32_t s = generator() % segs.size();
+                uint32_t index = generator() % counts[s];
+
+                Buffer value;
+                uint32_t size;
+                uint64_t start = Cycles::rdtsc();
+                const char* found = list.readElement(segs[s], index, &value,
+                    &size);
+                uint64_t end = Cycles::rdtsc();
+                getHist.record(Cycles::toNanoseconds(end-start));
+
+                if (found == NULL || size != element_size)
+                  printf("ERROR: Element %d of segment %d not found\n", index, segs[s]);
+              }
+
+              // Scan: walks the whole list.
+              LatencyHistogram scanHist(histogram_precision);
+              for (int i = 0; i < scans_per_point; i++) {
+                uint64_t start = Cycles::rdtsc();
+                uint64_t found = list.check(false);
+                uint64_t end = Cycles::rdtsc();
+                scanHist.record(Cycles::toNanoseconds(end-start));
+
+                if (found != samples_per_point)
+                  printf("ERROR: List holds %lu elements, expected %d\n", found, samples_per_point);
+              }
+
+              const char* opNames[] = {"append", "get", "scan"};
+              LatencyHistogram* hists[] = {&appendHist, &getHist, &scanHist};
+              for (int o = 0; o < 3; o++) {
+                fprintf(datFile, "%12d %12s %12s %12.1f", 
+                    head_segment_size,
+                    layoutName,
+                    opNames[o],
+                    hists[o]->getMean() / 1000.0);
+                hists[o]->printPercentiles(datFile, 1000.0, 1);
+                fprintf(datFile, " %12lu\n", 
+                    hists[o]->getCount());
+              }
+              fflush(datFile);
             }
+          }
+
+          fclose(datFile);
+        }
+
+        client.dropTable("test");
+      } else if (op.compare("scan") == 0) {
+        uint64_t tableId = client.createTable("test");
+        List::Layout layout = (list_layout.compare("tail") == 0) ?
+            List::TAIL_APPEND : List::FRONT_INSERT;
+
+        for (int es_idx = 0; es_idx < element_sizes.size(); es_idx++) {
+          uint32_t element_size = element_sizes[es_idx];
 
-            fprintf(datFile, "%12d %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n", 
-                head_segment_size,
-                (double)sum / (double)samples_per_point / 1000.0,
-                latencyVec[samples_per_point*1/100]/1000.0,
-                latencyVec[samples_per_point*2/100]/1000.0,
-                latencyVec[samples_per_point*5/100]/1000.0,
-                latencyVec[samples_per_point*10/100]/1000.0,
-                latencyVec[samples_per_point*25/100]/1000.0,
-                latencyVec[samples_per_point*50/100]/1000.0,
-                latencyVec[samples_per_point*75/100]/1000.0,
-                latencyVec[samples_per_point*90/100]/1000.0,
-                latencyVec[samples_per_point*95/100]/1000.0,
-                latencyVec[samples_per_point*98/100]/1000.0,
-                latencyVec[samples_per_point*99/100]/1000.0);
-            fflush(datFile);
+          // Open data file for writing.
+          FILE * datFile;
+          char filename[128];
+          sprintf(filename, "scan.spp_%d.es_%d.ly_%s.ms_%d.pd_%d.csv", samples_per_point, element_size, list_layout.c_str(), multi_size, pipeline_depth);
+          datFile = fopen(filename, "w");
+          fprintf(datFile, "%12s %12s %12s %12s %12s", 
+              "Length",
+              "SegSize",
+              "Segments",
+              "Method",
+              "Avg");
+          LatencyHistogram::printHeader(datFile);
+          fprintf(datFile, " %12s\n", 
+              "Samples");
+
+          for (int hs_idx = 0; hs_idx < head_segment_sizes.size(); hs_idx++) {
+            uint32_t head_segment_size = head_segment_sizes[hs_idx];
+
+            // List lengths are swept in increasing order, so one list is
+            // grown from each point to the next.
+            List list(&client, tableId, head_segment_size, true, true,
+                layout);
+            char element[element_size];
+            memset(element, 0, element_size);
+            uint32_t length = 0;
+
+            for (int ll_idx = 0; ll_idx < list_lengths.size(); ll_idx++) {
+              uint32_t list_length = list_lengths[ll_idx];
+              printf("Scan Test: element_size: %dB, head_segment_size: %dB, list_length: %d\n", element_size, head_segment_size, list_length);
+
+              for (; length < list_length; length++)
+                list.append(element, element_size);
+
+              Buffer headValue;
+              list.readSegment(0, &headValue);
+              uint32_t numTailSegs = *headValue.getOffset<uint32_t>(0);
+
+              // Read: check(), one read per segment.
+              LatencyHistogram readHist(histogram_precision);
+              for (int i = 0; i < samples_per_point; i++) {
+                uint64_t start = Cycles::rdtsc();
+                uint64_t found = list.check(false);
+                uint64_t end = Cycles::rdtsc();
+                readHist.record(Cycles::toNanoseconds(end-start));
+
+                if (found != list_length)
+                  printf("ERROR: List holds %lu elements, expected %d\n", found, list_length);
+              }
+
+              // ReadAll: pipelined multiReads, touching every element.
+              LatencyHistogram readAllHist(histogram_precision);
+              for (int i = 0; i < samples_per_point; i++) {
+                uint64_t bytes = 0;
+                uint64_t start = Cycles::rdtsc();
+                uint64_t found = list.readAll(
+                    [&](const char* data, uint32_t size) {
+                      bytes += size;
+                    }, multi_size, pipeline_depth);
+                uint64_t end = Cycles::rdtsc();
+                readAllHist.record(Cycles::toNanoseconds(end-start));
+
+                if (found != list_length ||
+                    bytes != (uint64_t)list_length * element_size)
+                  printf("ERROR: readAll found %lu elements (%lu bytes), expected %d\n", found, bytes, list_length);
+              }
+
+              const char* methodNames[] = {"read", "readAll"};
+              LatencyHistogram* hists[] = {&readHist, &readAllHist};
+              for (int m = 0; m < 2; m++) {
+                fprintf(datFile, "%12d %12d %12d %12s %12.1f", 
+                    list_length,
+                    head_segment_size,
+                    numTailSegs + 1,
+                    methodNames[m],
+                    hists[m]->getMean() / 1000.0);
+                hists[m]->printPercentiles(datFile, 1000.0, 1);
+                fprintf(datFile, " %12lu\n", 
+                    hists[m]->getCount());
+              }
+              fflush(datFile);
+            }
+          }
+
+          fclose(datFile);
+        }
+
+        client.dropTable("test");
+      } else if (op.compare("get") == 0 || op.compare("range") == 0) {
+        uint64_t tableId = client.createTable("test");
+        List::Layout layout = (list_layout.compare("tail") == 0) ?
+            List::TAIL_APPEND : List::FRONT_INSERT;
+        // A get is a range of one element.
+        bool isRange = (op.compare("range") == 0);
+        uint32_t elements_per_sample = isRange ? range_size : 1;
+
+        for (int es_idx = 0; es_idx < element_sizes.size(); es_idx++) {
+          uint32_t element_size = element_sizes[es_idx];
+
+          // Open data file for writing.
+          FILE * datFile;
+          char filename[128];
+          if (isRange)
+            sprintf(filename, "range.spp_%d.es_%d.ly_%s.rs_%d.csv", samples_per_point, element_size, list_layout.c_str(), range_size);
+          else
+            sprintf(filename, "get.spp_%d.es_%d.ly_%s.csv", samples_per_point, element_size, list_layout.c_str());
+          datFile = fopen(filename, "w");
+          fprintf(datFile, "%12s %12s %12s %12s", 
+              "Length",
+              "SegSize",
+              "Segments",
+              "Avg");
+          LatencyHistogram::printHeader(datFile);
+          fprintf(datFile, " %12s\n", 
+              "Samples");
+
+          for (int hs_idx = 0; hs_idx < head_segment_sizes.size(); hs_idx++) {
+            uint32_t head_segment_size = head_segment_sizes[hs_idx];
+
+            // List lengths are swept in increasing order, so one list is
+            // grown from each point to the next.
+            List list(&client, tableId, head_segment_size, true, true,
+                layout);
+            char element[element_size];
+            memset(element, 0, element_size);
+            uint32_t length = 0;
+
+            for (int ll_idx = 0; ll_idx < list_lengths.size(); ll_idx++) {
+              uint32_t list_length = list_lengths[ll_idx];
+              printf("%s Test: element_size: %dB, head_segment_size: %dB, list_length: %d\n", isRange ? "Range" : "Get", element_size, head_segment_size, list_length);
+
+              // Every element starts with its position, to check what is
+              // read.
+              for (; length < list_length; length++) {
+                if (element_size >= sizeof(uint32_t))
+                  memcpy(element, &length, sizeof(uint32_t));
+                list.append(element, element_size);
+              }
+
+              Buffer headValue;
+              list.readSegment(0, &headValue);
+              uint32_t numTailSegs = *headValue.getOffset<uint32_t>(0);
+
+              // Ranges start at uniformly chosen positions and lie within
+              // the list.
+              uint32_t count = std::min(elements_per_sample, list_length);
+              std::mt19937 generator(0);
+              LatencyHistogram latencyHist(histogram_precision);
+              for (int i = 0; i < samples_per_point; i++) {
+                uint32_t first = generator() % (list_length - count + 1);
+                uint32_t next = first;
+                bool wrong = false;
+                auto visit = [&](const char* data, uint32_t size) {
+                  if (size != element_size ||
+                      (size >= sizeof(uint32_t) &&
+                       *(const uint32_t*)data != next))
+                    wrong = true;
+                  next++;
+                };
+
+                uint64_t start = Cycles::rdtsc();
+                uint64_t found;
+                if (isRange)
+                  found = list.range(first, first + count, visit);
+                else
+                  found = list.get(first, visit) ? 1 : 0;
+                uint64_t end = Cycles::rdtsc();
+                latencyHist.record(Cycles::toNanoseconds(end-start));
+
+                if (found != count || wrong)
+                  printf("ERROR: Read %lu elements at position %d, expected %d\n", found, first, count);
+              }
+
+              fprintf(datFile, "%12d %12d %12d %12.1f", 
+                  list_length,
+                  head_segment_size,
+                  numTailSegs + 1,
+                  latencyHist.getMean() / 1000.0);
+              latencyHist.printPercentiles(datFile, 1000.0, 1);
+              fprintf(datFile, " %12lu\n", 
+                  latencyHist.getCount());
+              fflush(datFile);
+            }
           }
 
           fclose(datFile);
         }
 
         client.dropTable("test");
-      } // op == "append"
+      } // op == "get" || op == "range"
     } // while (true) // cfg file reading
   
     return 0;
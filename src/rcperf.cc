@@ -21,6 +21,8 @@
 #include <cmath>
 #include <iostream>
 #include <fstream>
+#include <random>
+#include <sstream>
 
 #include "ClusterMetrics.h"
 #include "Context.h"
@@ -33,9 +35,27 @@
 #include "RamCloud.h"
 #include "Tub.h"
 #include "IndexLookup.h"
+#include "MultiIncrement.h"
+#include "MultiRead.h"
+#include "MultiRemove.h"
+#include "MultiWrite.h"
 #include "TableEnumerator.h"
 #include "Transaction.h"
 
+#include "BulkLoader.h"
+#include "ClientThreads.h"
+#include "DatasetPlanner.h"
+#include "KeySet.h"
+#include "LatencyHistogram.h"
+#include "OpenLoopGenerator.h"
+#include "PointMetrics.h"
+#include "PointSampler.h"
+#include "RequestArena.h"
+#include "StageBreakdown.h"
+#include "SweepJournal.h"
+#include "TraceWriter.h"
+#include "YcsbWorkload.h"
+
 using namespace RAMCloud;
 
 /* Sweeping parameters in configuration file. Each is suffixed with {_start,
@@ -53,36 +73,169 @@ using namespace RAMCloud;
  *   - server_size (ss): The number of RAMCloud servers to use in the 
  *   experiment.
  *   - value_size (vs): The size of RAMCloud object values in bytes.
+ *   - threads (th): The number of client threads issuing operations
+ *   concurrently, each with its own RamCloud instance and its own set of keys.
+ *   Defaults to 1. Only used by the experiments that list it below.
+ *   - offered_rate (or): The rate, in operations per second, at which an
+ *   open-loop experiment schedules requests.
+ *   - pipeline_depth (pd): The number of asynchronous RPCs an experiment keeps
+ *   in flight at once. Defaults to 1.
+ *   - indexlets (il): The number of indexlets each secondary index is split
+ *   into. Defaults to 1.
+ *   - read_set_size (rs): The number of objects read by each transaction.
+ *   - write_set_size (ws): The number of objects written by each transaction.
  *
  * Fixed parameters (maintain their value during experiment, not swept).
  *   - samples_per_point (spp): Number of measurements to take for each data 
  *       point.
+ *   - histogram_precision: Number of significant decimal digits to which
+ *       latency samples are kept (1 to 5, default 3). Samples are recorded in
+ *       a fixed-size LatencyHistogram, so samples_per_point is not limited by
+ *       memory. Every experiment reports the 1th through 99.99th percentiles
+ *       and the maximum.
+ *   - load_batch_size: Number of objects per multiWrite when loading an
+ *       experiment's dataset (default 1000).
+ *   - load_pipeline_depth: Number of dataset loading multiWrites kept in
+ *       flight at once (default 4). Load throughput is printed after every
+ *       load.
+ *   - arrival_mode (am): How open-loop experiments space out requests, either
+ *       poisson (exponential inter-arrival times, the default) or fixed.
+ *   - max_outstanding (mo): Maximum number of RPCs an open-loop experiment
+ *       keeps in flight. Defaults to 32.
+ *   - late_threshold_us: An open-loop request sent more than this many
+ *       microseconds after its scheduled time is counted as late. Defaults
+ *       to 5.
+ *   - num_indexes (ni): Number of secondary indexes created on indexed
+ *       tables. Defaults to 1.
+ *   - workload (wl): YCSB core workload to run in the ycsb experiment, one of
+ *       a through f (default a). The operation mix and request distribution
+ *       of the chosen workload can be overridden with the parameters below.
+ *   - read_proportion, update_proportion, insert_proportion,
+ *       scan_proportion, rmw_proportion: Relative frequency of each ycsb
+ *       operation. Unset ones keep the workload's value.
+ *   - request_distribution: How ycsb chooses records: uniform, zipfian,
+ *       latest or hotspot. Defaults to the workload's.
+ *   - zipfian_theta: Skew of the zipfian and latest distributions (default
+ *       0.99).
+ *   - hotspot_data_fraction, hotspot_op_fraction: For the hotspot
+ *       distribution, hotspot_op_fraction of operations go to the first
+ *       hotspot_data_fraction of records (defaults 0.2 and 0.8).
+ *   - record_count (rc): Number of records loaded before a ycsb run (default
+ *       100000).
+ *   - max_scan_length: Longest ycsb scan, in records (default 100).
+ *   - hot_key_count (hk): When non-zero, every thread of the transaction
+ *       experiment picks its read and write sets at random from the same
+ *       hot_key_count objects, so transactions conflict. Defaults to 0,
+ *       which gives every thread its own objects.
+ *   - warmup_samples: Number of samples every closed-loop experiment takes
+ *       and throws away at the start of each point (per thread), before it
+ *       starts measuring. Defaults to 0.
+ *   - ci_target: When non-zero, closed-loop experiments sample each point
+ *       adaptively, stopping once the ci_confidence confidence interval of
+ *       the ci_percentile'th percentile latency is narrower than ci_target
+ *       times the percentile (e.g. 0.02 for +/-1%). samples_per_point then
+ *       caps the number of samples. Defaults to 0 (always take
+ *       samples_per_point samples).
+ *   - ci_percentile: Percentile whose confidence interval ci_target applies
+ *       to (default 50, e.g. 99 for tail latency).
+ *   - ci_confidence: Confidence level of the interval (default 0.95).
+ *   - min_samples: Fewest samples an adaptively sampled point takes (default
+ *       100).
+ *   - max_point_seconds: Time budget of an adaptively sampled point, in
+ *       seconds. Defaults to 0 (no limit).
+ *   Closed-loop experiments report the number of samples measured and the
+ *   relative width of the confidence interval in their Samples and CIWidth
+ *   columns.
+ *   - server_metrics: Server counters to record for every point, as a list
+ *       of patterns such as "rpc.*Count" matched against the names of the
+ *       servers' ClusterMetrics (ignoring case). The change in each matching
+ *       counter over a point, from every server, goes to a companion of the
+ *       output file (<file>.metrics.csv), one row per counter and server,
+ *       starting with the point's parameter columns. Only counters that
+ *       changed are written. Defaults to RPC counts, dispatch and worker
+ *       active cycles, bytes transmitted and received, retransmissions and
+ *       log cleaner counters; "none" turns recording off.
+ *   - timetrace_every: When non-zero, the read and multiread experiments
+ *       time one out of every timetrace_every measured samples stage by
+ *       stage: Send (building and sending the request), Response (polling
+ *       until the response has arrived) and Complete (handling the response
+ *       in wait()). The mean time of each stage at every point goes to
+ *       <file>.stages.csv. The stages are also recorded in RAMCloud's
+ *       TimeTrace, next to RAMCloud's own tracepoints, and the trace is
+ *       printed to the log after every point. Defaults to 0 (off).
+ *
+ * The read-only multiread experiments (multiread, multiread_fixeddss,
+ * multiread_fixeddss_chunked, multiread_fixeddss_chunked_pipelined and
+ * readop_async) share one table through a DatasetPlanner, which remembers
+ * which objects are loaded and only loads what a point is missing. The table
+ * is kept between sections, and each of these sections starts with the
+ * server_size and value sizes already loaded. The load time saved is printed
+ * at the end of every such section.
+ *
+ * Every completed point is recorded in a journal next to its output file
+ * (<file>.csv.journal), along with a hash of the configuration. After a
+ * crash, rerunning with --resume and the same configuration skips the points
+ * in the journal, loads only the datasets that the remaining points need and
+ * appends to the existing output file.
+ *
+ * With --trace <file>, every measured (non-warmup) sample of the closed-loop
+ * experiments is also written to a binary trace as a fixed-width record of
+ * timestamp, latency, op type and point id. Points are listed in
+ * <file>.points with their output file and parameter values. The op type is
+ * 0 except in ycsb, where it is the operation (0 read, 1 update, 2 insert,
+ * 3 scan, 4 read-modify-write), and in scan, where parallel scans are 1. The
+ * rctrace tool maps a trace and recomputes percentiles per point and op
+ * type, optionally over a time window or in time slices.
  *
  * Experiments:
  *   - read: Measures the latency of RAMCloud object reads over various key and
- *   value sizes.
+ *   value sizes. With more than one thread each thread reads its own object,
+ *   and the aggregate throughput of all threads is reported in ops/s and
+ *   value bytes/s next to the latency percentiles.
  *     - Parameters:
  *       - key_size
  *       - value_size
- *       - samples_per_point
+ *       - threads
+ *       - samples_per_point: Here samples_per_point is per thread.
  *   - write: Measures the latency of RAMCloud object writes over various key
  *   and value sizes. Note below that replication factor is not currently a
  *   parameter. The user must specify at the command line the number of replicas
  *   using the --replicas option, which is recorded in the output file name.
+ *   Throughput is reported the same way as for read.
  *     - Parameters:
  *       - key_size
  *       - value_size
- *       - samples_per_point
+ *       - threads
+ *       - samples_per_point: Here samples_per_point is per thread.
  *   - multiread: Measures the latency of RAMCloud multireads over various key,
  *   value, multiread sizes, and number of servers. For multiple servers, keys
  *   are specially selected to produce an even distribution of RAMCloud objects
- *   over the servers.
+ *   over the servers (see KeySet; generated key sets are cached between runs
+ *   in the directory given by --keyCacheDir, if any). With more than one
+ *   thread each thread multireads its own multi_size objects, and aggregate
+ *   throughput is reported in objects/s and value bytes/s.
  *     - Parameters:
  *       - key_size
  *       - value_size
  *       - multi_size
  *       - server_size
- *       - samples_per_point
+ *       - threads
+ *       - samples_per_point: Here samples_per_point is per thread.
+ *   - multiwrite, multiremove, multiincrement: Measure the latency of
+ *   RAMCloud multiWrites, multiRemoves and multiIncrements, with the same
+ *   parameters, key layout and output columns as multiread, followed by the
+ *   percentiles of whole-batch latency (columns prefixed with "Batch"). As
+ *   for write, the number of replicas given with --replicas is recorded in
+ *   the output file name. multiremove rewrites the removed objects after
+ *   every sample, outside of the measurement. multiincrement always uses
+ *   8 byte integer values and ignores value_size.
+ *     - Parameters:
+ *       - key_size
+ *       - value_size
+ *       - multi_size
+ *       - server_size
+ *       - threads
+ *       - samples_per_point: Here samples_per_point is per thread.
  *   - multiread_fixeddss: Measures the latency of RAMCloud multireads over
  *   various multiread sizes, where object sizes are automatically calculated to
  *   be ds_size / multi_size (inlcuding keys and values), effectively holding
@@ -90,7 +243,9 @@ using namespace RAMCloud;
  *   varying multi_size. The aim of this experiment is find the optimal number
  *   of RAMCloud objects over which to spread ds_size bytes of data. For
  *   multiple servers, keys are specially selected to produce an even
- *   distribution of RAMCloud objects over the servers.
+ *   distribution of RAMCloud objects over the servers. Points are run
+ *   grouped by value size, in increasing multi_size order, so that each
+ *   dataset is loaded once (see DatasetPlanner); rows appear in that order.
  *     - Parameters:
  *       - ds_size
  *       - multi_size
@@ -110,18 +265,130 @@ using namespace RAMCloud;
  *       - multi_size
  *       - server_size
  *       - samples_per_point
- *   - readop_async: Measures the latency of asynchronous batched ReadOps
- *   over various batch sizes, key/value sizes, and number of servers. ReadOps
- *   are constructed together and then wait() is called to execute them in a
- *   batch. For multiple servers, keys are specially selected to produce an even 
- *   distribution of RAMCloud objects over the servers.
+ *   - multiread_fixeddss_chunked_pipelined: Like multiread_fixeddss_chunked,
+ *   but chunks are read with asynchronous MultiRead RPCs, up to
+ *   pipeline_depth of which are kept in flight at once, so that the reads of
+ *   consecutive chunks overlap. Reports the time to read the whole dataset
+ *   and the effective read bandwidth in GB/s (dataset key and value bytes
+ *   over the mean read time).
+ *     - Parameters:
+ *       - ds_size: As for multiread_fixeddss_chunked, the # of objects.
+ *       - key_size
+ *       - value_size
+ *       - multi_size
+ *       - pipeline_depth
+ *       - server_size
+ *       - samples_per_point
+ *   - readop_async: Measures the latency of reading multi_size objects with
+ *   asynchronous ReadOps over various batch sizes, key/value sizes, window
+ *   depths, and number of servers. ReadOps are issued unbatched, so each is
+ *   sent as soon as it is constructed, from a sliding window of
+ *   pipeline_depth slots: whichever outstanding ReadOp completes first has
+ *   its slot reused for the next read. The time to read all multi_size objects is reported (for
+ *   comparison with multiread at the same multi_size), followed by the
+ *   per-ReadOp latency from construction to completion (columns prefixed
+ *   with "Op"). For multiple servers, keys are specially selected to produce
+ *   an even distribution of RAMCloud objects over the servers.
+ *     - Parameters:
+ *       - key_size
+ *       - value_size
+ *       - multi_size: Here multi_size refers to the # of ReadOps issued per
+ *       sample.
+ *       - pipeline_depth: Here pipeline_depth refers to the # of ReadOps
+ *       outstanding at once.
+ *       - server_size
+ *       - samples_per_point
+ *   - scan: Measures the time to enumerate every object in a table of ds_size
+ *   objects spread evenly over server_size tablets. Each point is measured
+ *   twice: once with a single TableEnumerator (Enumerators = 1) and once with
+ *   one enumerator per tablet running in parallel, each on its own thread and
+ *   restricted to its tablet's hash range (Enumerators = server_size). Each
+ *   parallel enumerator's client first enumerates its tablet once untimed,
+ *   so both measurements are taken with clients that already know the
+ *   tablet map and have sessions open.
+ *   Reported are percentiles of the full scan time, the median time to the
+ *   first object (FirstObj, in microseconds), and scan throughput in objects/s
+ *   and key plus value bytes/s. ds_size points are loaded incrementally, so
+ *   they should be given in increasing order.
  *     - Parameters:
+ *       - ds_size: Here ds_size refers to # of objects in the table.
  *       - key_size
  *       - value_size
- *       - multi_size: Here multi_size refers to the # of ReadOps batched
- *       together before being issued by a call to wait().
  *       - server_size
  *       - samples_per_point
+ *   - index_lookup: Measures secondary index performance. For each point a
+ *   table of ds_size objects is loaded twice, once without indexes and once
+ *   with num_indexes secondary indexes of indexlets indexlets each, recording
+ *   the latency of every insert. Every object's secondary keys are its
+ *   number zero padded to key_size, so key order matches object order. Then
+ *   IndexLookup is used to look up ranges of multi_size consecutive secondary
+ *   keys (multi_size of 1 is a point lookup). Lookup latency percentiles and
+ *   objects/s go to an index_lookup file. Insert latency percentiles for the
+ *   indexed table, the median insert latency without indexes, and the ratio of
+ *   the median with indexes to the median without (Slowdown50th, a latency
+ *   slowdown rather than a count of extra writes) go to an index_insert file.
+ *     - Parameters:
+ *       - ds_size: Here ds_size refers to # of objects in the table.
+ *       - key_size: Size of both primary and secondary keys.
+ *       - value_size
+ *       - multi_size: Here multi_size refers to the # of objects in each
+ *       range lookup.
+ *       - indexlets
+ *       - num_indexes
+ *       - server_size
+ *       - samples_per_point: Here samples_per_point is the number of lookups
+ *       per point.
+ *   - transaction: Measures the latency of committing RAMCloud transactions
+ *   that read read_set_size objects and write write_set_size others, spread
+ *   over server_size servers. Each thread runs samples_per_point
+ *   transactions back to back. Reported are percentiles of commit() latency
+ *   over all transactions, the aggregate rate of successful commits, and the
+ *   fraction of commits that aborted. Without hot_key_count every thread
+ *   uses its own objects and nothing should abort; with it, threads contend
+ *   for the same hot objects.
+ *     - Parameters:
+ *       - value_size
+ *       - read_set_size
+ *       - write_set_size
+ *       - server_size
+ *       - threads
+ *       - hot_key_count
+ *       - samples_per_point: Here samples_per_point is per thread.
+ *   - ycsb: Runs a YCSB-style mixed workload (see YcsbWorkload) against a
+ *   table of record_count records spread over server_size tablets. Each
+ *   thread performs samples_per_point operations chosen according to the
+ *   workload's operation mix and request distribution. RAMCloud has no
+ *   ordered primary key scans, so a scan is a multiread of consecutive
+ *   record numbers. A read-modify-write is a read followed by a write of the
+ *   same record and is timed as a whole. One row is reported per operation
+ *   type with latency percentiles and that operation's aggregate rate,
+ *   followed by a TOTAL row over all operations.
+ *     - Parameters:
+ *       - key_size
+ *       - value_size
+ *       - server_size
+ *       - threads
+ *       - workload and the other ycsb fixed parameters above
+ *       - samples_per_point: Here samples_per_point is per thread.
+ *   - read_openloop: Measures the latency of RAMCloud object reads under an
+ *   open-loop load. Reads are issued asynchronously on a schedule at the
+ *   offered rate regardless of when earlier reads complete, and latency is
+ *   measured from each read's scheduled send time, so queueing behind slow
+ *   responses shows up in the tail. Alongside the percentiles, the achieved
+ *   rate and the number of late and dropped reads are reported (see
+ *   OpenLoopGenerator for their definitions).
+ *     - Parameters:
+ *       - key_size
+ *       - value_size
+ *       - offered_rate
+ *       - arrival_mode
+ *       - max_outstanding
+ *       - late_threshold_us
+ *       - samples_per_point: Here samples_per_point is the number of requests
+ *       scheduled per point.
+ *   - write_openloop: Same as read_openloop, but for writes. The number of
+ *   replicas is recorded in the output file name as for write.
+ *     - Parameters: same as read_openloop.
  */
 
 int
@@ -132,6 +399,9 @@ try
     int numClients;
     int replicas;
     std::string configFilename;
+    std::string keyCacheDir;
+    bool resume;
+    std::string traceFilename;
 
     // Set line buffering for stdout so that printf's and log messages
     // interleave properly.
@@ -159,7 +429,19 @@ try
          "Number of replicas configured for given RAMCloud cluster.")
         ("config",
          ProgramOptions::value<std::string>(&configFilename),
-         "Configuration file for experiment specification.");
+         "Configuration file for experiment specification.")
+        ("keyCacheDir",
+         ProgramOptions::value<std::string>(&keyCacheDir),
+         "Directory in which to cache generated key sets between runs. "
+         "Key sets are not cached if this is not given.")
+        ("resume",
+         ProgramOptions::bool_switch(&resume),
+         "Resume an interrupted run: skip the points already recorded in "
+         "each output file's journal and append to the output file.")
+        ("trace",
+         ProgramOptions::value<std::string>(&traceFilename),
+         "Binary file to write every measured sample to (see rctrace). "
+         "Samples are not traced if this is not given.");
     
     OptionParser optionParser(clientOptions, argc, argv);
     context.transportManager->setSessionTimeout(
@@ -175,6 +457,11 @@ try
 
     RamCloud client(&optionParser.options);
 
+    // Datasets of read-only experiments stay resident across sections.
+    DatasetPlanner planner(&client);
+
+    TraceWriter trace(traceFilename);
+
     // Default values for experiment parameters
     uint32_t key_size_start = 30;
     uint32_t key_size_end = 30;
@@ -196,11 +483,69 @@ try
     uint32_t server_size_end = 1;
     uint32_t server_size_points = 1;
     std::string server_size_mode = "l";
+    uint32_t threads_start = 1;
+    uint32_t threads_end = 1;
+    uint32_t threads_points = 1;
+    std::string threads_mode = "l";
+    uint32_t offered_rate_start = 10000;
+    uint32_t offered_rate_end = 10000;
+    uint32_t offered_rate_points = 1;
+    std::string offered_rate_mode = "l";
+    uint32_t pipeline_depth_start = 1;
+    uint32_t pipeline_depth_end = 1;
+    uint32_t pipeline_depth_points = 1;
+    std::string pipeline_depth_mode = "l";
+    uint32_t indexlets_start = 1;
+    uint32_t indexlets_end = 1;
+    uint32_t indexlets_points = 1;
+    std::string indexlets_mode = "l";
+    uint32_t read_set_size_start = 1;
+    uint32_t read_set_size_end = 1;
+    uint32_t read_set_size_points = 1;
+    std::string read_set_size_mode = "l";
+    uint32_t write_set_size_start = 1;
+    uint32_t write_set_size_end = 1;
+    uint32_t write_set_size_points = 1;
+    std::string write_set_size_mode = "l";
     uint32_t samples_per_point = 1000;
+    uint32_t histogram_precision = 3;
+    uint32_t load_batch_size = 1000;
+    uint32_t load_pipeline_depth = 4;
+    std::string arrival_mode = "poisson";
+    uint32_t max_outstanding = 32;
+    uint32_t late_threshold_us = 5;
+    uint32_t num_indexes = 1;
+    uint32_t hot_key_count = 0;
+    std::string workload = "a";
+    double read_proportion = -1;
+    double update_proportion = -1;
+    double insert_proportion = -1;
+    double scan_proportion = -1;
+    double rmw_proportion = -1;
+    std::string request_distribution = "";
+    double zipfian_theta = 0.99;
+    double hotspot_data_fraction = 0.2;
+    double hotspot_op_fraction = 0.8;
+    uint32_t record_count = 100000;
+    uint32_t max_scan_length = 100;
+    uint32_t warmup_samples = 0;
+    double ci_target = 0;
+    double ci_percentile = 50;
+    double ci_confidence = 0.95;
+    uint32_t min_samples = 100;
+    double max_point_seconds = 0;
+    uint32_t timetrace_every = 0;
+    std::vector<std::string> server_metrics = {"rpc.*Count", "*ActiveCycles",
+        "transport.*.byteCount", "*retransmit*", "*cleaner*"};
 
     std::ifstream cfgFile(configFilename);
     std::string line;
     std::string op;
+
+    // Every setting read so far. Parameters carry over from one section to
+    // the next, so a section's results depend on all of the sections before
+    // it.
+    std::string configText;
     while (true) {
       if (cfgFile.eof()) {
         printf("End of experiments\n");
@@ -209,6 +554,9 @@ try
 
       bool foundCfg = false;
       while (std::getline(cfgFile, line)) {
+        if (line.size() > 0 && line[0] != '#')
+          configText += line + "\n";
+
         if (line[0] == '[') {
           op = line.substr(1, line.find_last_of(']') - 1);
           foundCfg = true;
@@ -348,10 +696,346 @@ try
             }
 
             server_size_mode = var_value;
+          } else if (var_name.compare("threads_start") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            threads_start = var_int_value;
+          } else if (var_name.compare("threads_end") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            threads_end = var_int_value;
+          } else if (var_name.compare("threads_points") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            threads_points = var_int_value;
+          } else if (var_name.compare("threads_mode") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+
+            if (var_value.compare("linear") == 0)
+              var_value = "l";
+            else if (var_value.compare("geometric") == 0)
+              var_value = "g";
+            else {
+              printf("ERROR: Unknown parameter stepping mode: %s\n", var_value.c_str());
+              return 1;
+            }
+
+            threads_mode = var_value;
+          } else if (var_name.compare("offered_rate_start") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            offered_rate_start = var_int_value;
+          } else if (var_name.compare("offered_rate_end") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            offered_rate_end = var_int_value;
+          } else if (var_name.compare("offered_rate_points") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            offered_rate_points = var_int_value;
+          } else if (var_name.compare("offered_rate_mode") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+
+            if (var_value.compare("linear") == 0)
+              var_value = "l";
+            else if (var_value.compare("geometric") == 0)
+              var_value = "g";
+            else {
+              printf("ERROR: Unknown parameter stepping mode: %s\n", var_value.c_str());
+              return 1;
+            }
+
+            offered_rate_mode = var_value;
+          } else if (var_name.compare("pipeline_depth_start") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            pipeline_depth_start = var_int_value;
+          } else if (var_name.compare("pipeline_depth_end") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            pipeline_depth_end = var_int_value;
+          } else if (var_name.compare("pipeline_depth_points") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            pipeline_depth_points = var_int_value;
+          } else if (var_name.compare("pipeline_depth_mode") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+
+            if (var_value.compare("linear") == 0)
+              var_value = "l";
+            else if (var_value.compare("geometric") == 0)
+              var_value = "g";
+            else {
+              printf("ERROR: Unknown parameter stepping mode: %s\n", var_value.c_str());
+              return 1;
+            }
+
+            pipeline_depth_mode = var_value;
+          } else if (var_name.compare("indexlets_start") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            indexlets_start = var_int_value;
+          } else if (var_name.compare("indexlets_end") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            indexlets_end = var_int_value;
+          } else if (var_name.compare("indexlets_points") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            indexlets_points = var_int_value;
+          } else if (var_name.compare("indexlets_mode") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+
+            if (var_value.compare("linear") == 0)
+              var_value = "l";
+            else if (var_value.compare("geometric") == 0)
+              var_value = "g";
+            else {
+              printf("ERROR: Unknown parameter stepping mode: %s\n", var_value.c_str());
+              return 1;
+            }
+
+            indexlets_mode = var_value;
+          } else if (var_name.compare("read_set_size_start") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            read_set_size_start = var_int_value;
+          } else if (var_name.compare("read_set_size_end") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            read_set_size_end = var_int_value;
+          } else if (var_name.compare("read_set_size_points") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            read_set_size_points = var_int_value;
+          } else if (var_name.compare("read_set_size_mode") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+
+            if (var_value.compare("linear") == 0)
+              var_value = "l";
+            else if (var_value.compare("geometric") == 0)
+              var_value = "g";
+            else {
+              printf("ERROR: Unknown parameter stepping mode: %s\n", var_value.c_str());
+              return 1;
+            }
+
+            read_set_size_mode = var_value;
+          } else if (var_name.compare("write_set_size_start") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            write_set_size_start = var_int_value;
+          } else if (var_name.compare("write_set_size_end") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            write_set_size_end = var_int_value;
+          } else if (var_name.compare("write_set_size_points") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            write_set_size_points = var_int_value;
+          } else if (var_name.compare("write_set_size_mode") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+
+            if (var_value.compare("linear") == 0)
+              var_value = "l";
+            else if (var_value.compare("geometric") == 0)
+              var_value = "g";
+            else {
+              printf("ERROR: Unknown parameter stepping mode: %s\n", var_value.c_str());
+              return 1;
+            }
+
+            write_set_size_mode = var_value;
           } else if (var_name.compare("samples_per_point") == 0) {
             std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
             uint32_t var_int_value = std::stoi(var_value);
             samples_per_point = var_int_value;
+          } else if (var_name.compare("histogram_precision") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+
+            if (var_int_value < 1 || var_int_value > 5) {
+              printf("ERROR: histogram_precision must be between 1 and 5: %d\n", var_int_value);
+              return 1;
+            }
+
+            histogram_precision = var_int_value;
+          } else if (var_name.compare("load_batch_size") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+
+            if (var_int_value < 1) {
+              printf("ERROR: load_batch_size must be at least 1\n");
+              return 1;
+            }
+
+            load_batch_size = var_int_value;
+          } else if (var_name.compare("load_pipeline_depth") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+
+            if (var_int_value < 1) {
+              printf("ERROR: load_pipeline_depth must be at least 1\n");
+              return 1;
+            }
+
+            load_pipeline_depth = var_int_value;
+          } else if (var_name.compare("arrival_mode") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+
+            if (var_value.compare("poisson") != 0 && 
+                var_value.compare("fixed") != 0) {
+              printf("ERROR: Unknown arrival mode: %s\n", var_value.c_str());
+              return 1;
+            }
+
+            arrival_mode = var_value;
+          } else if (var_name.compare("max_outstanding") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+
+            if (var_int_value < 1) {
+              printf("ERROR: max_outstanding must be at least 1: %d\n", var_int_value);
+              return 1;
+            }
+
+            max_outstanding = var_int_value;
+          } else if (var_name.compare("late_threshold_us") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            late_threshold_us = var_int_value;
+          } else if (var_name.compare("num_indexes") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+
+            if (var_int_value < 1 || var_int_value > 254) {
+              printf("ERROR: num_indexes must be between 1 and 254: %d\n", var_int_value);
+              return 1;
+            }
+
+            num_indexes = var_int_value;
+          } else if (var_name.compare("hot_key_count") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            hot_key_count = var_int_value;
+          } else if (var_name.compare("workload") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            YcsbWorkload::Config preset;
+
+            if (!YcsbWorkload::getPreset(var_value, &preset)) {
+              printf("ERROR: Unknown workload: %s\n", var_value.c_str());
+              return 1;
+            }
+
+            workload = var_value;
+          } else if (var_name.compare("read_proportion") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            read_proportion = std::stod(var_value);
+          } else if (var_name.compare("update_proportion") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            update_proportion = std::stod(var_value);
+          } else if (var_name.compare("insert_proportion") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            insert_proportion = std::stod(var_value);
+          } else if (var_name.compare("scan_proportion") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            scan_proportion = std::stod(var_value);
+          } else if (var_name.compare("rmw_proportion") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            rmw_proportion = std::stod(var_value);
+          } else if (var_name.compare("request_distribution") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            YcsbWorkload::Distribution distribution;
+
+            if (!YcsbWorkload::parseDistribution(var_value, &distribution)) {
+              printf("ERROR: Unknown request distribution: %s\n", var_value.c_str());
+              return 1;
+            }
+
+            request_distribution = var_value;
+          } else if (var_name.compare("zipfian_theta") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            double var_double_value = std::stod(var_value);
+
+            if (var_double_value <= 0.0 || var_double_value >= 1.0) {
+              printf("ERROR: zipfian_theta must be between 0 and 1 (exclusive): %s\n", var_value.c_str());
+              return 1;
+            }
+
+            zipfian_theta = var_double_value;
+          } else if (var_name.compare("hotspot_data_fraction") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            hotspot_data_fraction = std::stod(var_value);
+          } else if (var_name.compare("hotspot_op_fraction") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            hotspot_op_fraction = std::stod(var_value);
+          } else if (var_name.compare("record_count") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+
+            if (var_int_value < 1) {
+              printf("ERROR: record_count must be at least 1\n");
+              return 1;
+            }
+
+            record_count = var_int_value;
+          } else if (var_name.compare("max_scan_length") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+
+            if (var_int_value < 1) {
+              printf("ERROR: max_scan_length must be at least 1\n");
+              return 1;
+            }
+
+            max_scan_length = var_int_value;
+          } else if (var_name.compare("warmup_samples") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            warmup_samples = var_int_value;
+          } else if (var_name.compare("ci_target") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            ci_target = std::stod(var_value);
+          } else if (var_name.compare("ci_percentile") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            double var_double_value = std::stod(var_value);
+
+            if (var_double_value <= 0.0 || var_double_value >= 100.0) {
+              printf("ERROR: ci_percentile must be between 0 and 100 (exclusive): %s\n", var_value.c_str());
+              return 1;
+            }
+
+            ci_percentile = var_double_value;
+          } else if (var_name.compare("ci_confidence") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            double var_double_value = std::stod(var_value);
+
+            if (var_double_value <= 0.0 || var_double_value >= 1.0) {
+              printf("ERROR: ci_confidence must be between 0 and 1 (exclusive): %s\n", var_value.c_str());
+              return 1;
+            }
+
+            ci_confidence = var_double_value;
+          } else if (var_name.compare("min_samples") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            min_samples = var_int_value;
+          } else if (var_name.compare("max_point_seconds") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            max_point_seconds = std::stod(var_value);
+          } else if (var_name.compare("timetrace_every") == 0) {
+            std::string var_value = line.substr(line.find_last_of(' ') + 1, line.length());
+            uint32_t var_int_value = std::stoi(var_value);
+            timetrace_every = var_int_value;
+          } else if (var_name.compare("server_metrics") == 0) {
+            std::istringstream var_values(line);
+            std::string var_value;
+            var_values >> var_value;
+            server_metrics.clear();
+            while (var_values >> var_value) {
+              if (var_value.compare("=") != 0 && var_value.compare("none") != 0)
+                server_metrics.push_back(var_value);
+            }
           } else {
             printf("ERROR: Unknown parameter: %s\n", var_name.c_str());
             return 1;
@@ -369,6 +1053,12 @@ try
       std::vector<uint32_t> ds_sizes; 
       std::vector<uint32_t> multi_sizes;
       std::vector<uint32_t> server_sizes;
+      std::vector<uint32_t> thread_counts;
+      std::vector<uint32_t> offered_rates;
+      std::vector<uint32_t> pipeline_depths;
+      std::vector<uint32_t> indexlet_counts;
+      std::vector<uint32_t> read_set_sizes;
+      std::vector<uint32_t> write_set_sizes;
 
       if (key_size_points > 1) {
         if (key_size_mode.compare("l") == 0) {
@@ -408,6 +1098,14 @@ try
         value_sizes.push_back(value_size_start);
       }
 
+      // Calculate the maximum value_size, used to size value buffers once for
+      // the whole sweep.
+      uint32_t value_size_max = 0;
+      for (int i = 0; i < value_sizes.size(); i++) {
+        if (value_sizes[i] > value_size_max)
+          value_size_max = value_sizes[i];
+      }
+
       if (ds_size_points > 1) {
         if (ds_size_mode.compare("l") == 0) {
           uint32_t step_size = 
@@ -481,149 +1179,371 @@ try
         server_sizes.push_back(server_size_start);
       }
 
-      if (op.compare("read") == 0) {
-        uint64_t tableId = client.createTable("test");
-
-        // Open data file for writing.
-        FILE * datFile;
-        char filename[512];
-        sprintf(filename, "read.spp_%d.ks_%d_%d_%d%s.vs_%d_%d_%d%s.csv", samples_per_point, key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str());
-        datFile = fopen(filename, "w");
-        fprintf(datFile, "%12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s\n", 
-            "KeySize",
-            "ValueSize",
-            "1th",
-            "2th",
-            "5th",
-            "10th",
-            "25th",
-            "50th",
-            "75th",
-            "90th",
-            "95th",
-            "98th",
-            "99th");
-
-        for (int ks_idx = 0; ks_idx < key_sizes.size(); ks_idx++) {
-          uint32_t key_size = key_sizes[ks_idx];
+      if (threads_points > 1) {
+        if (threads_mode.compare("l") == 0) {
+          uint32_t step_size = 
+            (threads_end - threads_start) / (threads_points - 1);
+
+          for (int i = threads_start; i <= threads_end; i += step_size) 
+            thread_counts.push_back(i);
+        } else if (threads_mode.compare("g") == 0) {
+          double c = pow(10, log10((double)threads_end/(double)threads_start) / (double)(threads_points - 1));
+          for (int i = threads_start; i <= threads_end; i = ceil(c * i))
+            thread_counts.push_back(i);
+        } else {
+          printf("ERROR: Unknown points mode: %s\n", threads_mode.c_str());
+          return 1;
+        }
+      } else {
+        thread_counts.push_back(threads_start);
+      }
 
-          for (int vs_idx = 0; vs_idx < value_sizes.size(); vs_idx++) {
-            uint32_t value_size = value_sizes[vs_idx];
-            printf("Read Test: key_size: %dB, value_size: %dB\n", key_size, value_size);
+      // Calculate the maximum number of threads, used later to write a
+      // separate set of keys for every thread up front.
+      uint32_t threads_max = 0;
+      for (int i = 0; i < thread_counts.size(); i++) {
+        if (thread_counts[i] > threads_max)
+          threads_max = thread_counts[i];
+      }
 
-            char randomKey[key_size];
-            char randomValue[value_size];
+      if (offered_rate_points > 1) {
+        if (offered_rate_mode.compare("l") == 0) {
+          uint32_t step_size = 
+            (offered_rate_end - offered_rate_start) / (offered_rate_points - 1);
+
+          for (int i = offered_rate_start; i <= offered_rate_end; i += step_size) 
+            offered_rates.push_back(i);
+        } else if (offered_rate_mode.compare("g") == 0) {
+          double c = pow(10, log10((double)offered_rate_end/(double)offered_rate_start) / (double)(offered_rate_points - 1));
+          for (int i = offered_rate_start; i <= offered_rate_end; i = ceil(c * i))
+            offered_rates.push_back(i);
+        } else {
+          printf("ERROR: Unknown points mode: %s\n", offered_rate_mode.c_str());
+          return 1;
+        }
+      } else {
+        offered_rates.push_back(offered_rate_start);
+      }
 
-            client.write(tableId, randomKey, key_size, randomValue, value_size);
+      if (pipeline_depth_points > 1) {
+        if (pipeline_depth_mode.compare("l") == 0) {
+          uint32_t step_size = 
+            (pipeline_depth_end - pipeline_depth_start) / (pipeline_depth_points - 1);
+
+          for (int i = pipeline_depth_start; i <= pipeline_depth_end; i += step_size) 
+            pipeline_depths.push_back(i);
+        } else if (pipeline_depth_mode.compare("g") == 0) {
+          double c = pow(10, log10((double)pipeline_depth_end/(double)pipeline_depth_start) / (double)(pipeline_depth_points - 1));
+          for (int i = pipeline_depth_start; i <= pipeline_depth_end; i = ceil(c * i))
+            pipeline_depths.push_back(i);
+        } else {
+          printf("ERROR: Unknown points mode: %s\n", pipeline_depth_mode.c_str());
+          return 1;
+        }
+      } else {
+        pipeline_depths.push_back(pipeline_depth_start);
+      }
 
-            Buffer value;
-            uint64_t latency[samples_per_point];
-            for (int i = 0; i < samples_per_point; i++) {
-              bool exists;
-              uint64_t start = Cycles::rdtsc();
-              client.read(tableId, randomKey, key_size, &value, NULL, NULL, &exists);
-              uint64_t end = Cycles::rdtsc();
-              latency[i] = Cycles::toNanoseconds(end-start);
-            }
+      // Calculate the maximum pipeline_depth, used to size request buffers
+      // once for the whole sweep.
+      uint32_t pipeline_depth_max = 0;
+      for (int i = 0; i < pipeline_depths.size(); i++) {
+        if (pipeline_depths[i] > pipeline_depth_max)
+          pipeline_depth_max = pipeline_depths[i];
+      }
 
-            std::vector<uint64_t> latencyVec(latency, latency+samples_per_point);
+      if (indexlets_points > 1) {
+        if (indexlets_mode.compare("l") == 0) {
+          uint32_t step_size = 
+            (indexlets_end - indexlets_start) / (indexlets_points - 1);
+
+          for (int i = indexlets_start; i <= indexlets_end; i += step_size) 
+            indexlet_counts.push_back(i);
+        } else if (indexlets_mode.compare("g") == 0) {
+          double c = pow(10, log10((double)indexlets_end/(double)indexlets_start) / (double)(indexlets_points - 1));
+          for (int i = indexlets_start; i <= indexlets_end; i = ceil(c * i))
+            indexlet_counts.push_back(i);
+        } else {
+          printf("ERROR: Unknown points mode: %s\n", indexlets_mode.c_str());
+          return 1;
+        }
+      } else {
+        indexlet_counts.push_back(indexlets_start);
+      }
 
-            std::sort(latencyVec.begin(), latencyVec.end());
+      if (read_set_size_points > 1) {
+        if (read_set_size_mode.compare("l") == 0) {
+          uint32_t step_size = 
+            (read_set_size_end - read_set_size_start) / (read_set_size_points - 1);
+
+          for (int i = read_set_size_start; i <= read_set_size_end; i += step_size) 
+            read_set_sizes.push_back(i);
+        } else if (read_set_size_mode.compare("g") == 0) {
+          double c = pow(10, log10((double)read_set_size_end/(double)read_set_size_start) / (double)(read_set_size_points - 1));
+          for (int i = read_set_size_start; i <= read_set_size_end; i = ceil(c * i))
+            read_set_sizes.push_back(i);
+        } else {
+          printf("ERROR: Unknown points mode: %s\n", read_set_size_mode.c_str());
+          return 1;
+        }
+      } else {
+        read_set_sizes.push_back(read_set_size_start);
+      }
 
-            uint64_t sum = 0;
-            for (int i = 0; i < samples_per_point; i++) {
-              sum += latencyVec[i];
-            }
+      if (write_set_size_points > 1) {
+        if (write_set_size_mode.compare("l") == 0) {
+          uint32_t step_size = 
+            (write_set_size_end - write_set_size_start) / (write_set_size_points - 1);
+
+          for (int i = write_set_size_start; i <= write_set_size_end; i += step_size) 
+            write_set_sizes.push_back(i);
+        } else if (write_set_size_mode.compare("g") == 0) {
+          double c = pow(10, log10((double)write_set_size_end/(double)write_set_size_start) / (double)(write_set_size_points - 1));
+          for (int i = write_set_size_start; i <= write_set_size_end; i = ceil(c * i))
+            write_set_sizes.push_back(i);
+        } else {
+          printf("ERROR: Unknown points mode: %s\n", write_set_size_mode.c_str());
+          return 1;
+        }
+      } else {
+        write_set_sizes.push_back(write_set_size_start);
+      }
 
-            fprintf(datFile, "%12d %12d %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n", 
-                key_size,
-                value_size,
-                latencyVec[samples_per_point*1/100]/1000.0,
-                latencyVec[samples_per_point*2/100]/1000.0,
-                latencyVec[samples_per_point*5/100]/1000.0,
-                latencyVec[samples_per_point*10/100]/1000.0,
-                latencyVec[samples_per_point*25/100]/1000.0,
-                latencyVec[samples_per_point*50/100]/1000.0,
-                latencyVec[samples_per_point*75/100]/1000.0,
-                latencyVec[samples_per_point*90/100]/1000.0,
-                latencyVec[samples_per_point*95/100]/1000.0,
-                latencyVec[samples_per_point*98/100]/1000.0,
-                latencyVec[samples_per_point*99/100]/1000.0);
-            fflush(datFile);
-          } // vs_idx
-        } // ks_idx
+      // Calculate the maximum read and write set sizes, used to lay out a
+      // separate set of keys for every thread up front.
+      uint32_t read_set_size_max = 0;
+      for (int i = 0; i < read_set_sizes.size(); i++) {
+        if (read_set_sizes[i] > read_set_size_max)
+          read_set_size_max = read_set_sizes[i];
+      }
 
-        fclose(datFile);
+      uint32_t write_set_size_max = 0;
+      for (int i = 0; i < write_set_sizes.size(); i++) {
+        if (write_set_sizes[i] > write_set_size_max)
+          write_set_size_max = write_set_sizes[i];
+      }
 
-        client.dropTable("test");
-      } else if (op.compare("write") == 0) {
+      // Journals of earlier runs are only resumed with the same settings.
+      uint32_t configHash = Crc32C().update(configText.data(),
+          (uint32_t)configText.size()).getResult();
+
+      // How many samples each point takes. See PointSampler.
+      PointSampler::Config samplingConfig = {warmup_samples, samples_per_point,
+          ci_target, ci_percentile, ci_confidence, min_samples,
+          max_point_seconds, trace.isEnabled() ? &trace : NULL};
+
+      if (op.compare("read") == 0) {
         uint64_t tableId = client.createTable("test");
+        RequestArena arena(0, value_size_max);
 
         // Open data file for writing.
         FILE * datFile;
         char filename[512];
-        sprintf(filename, "write.spp_%d.rf_%d.ks_%d_%d_%d%s.vs_%d_%d_%d%s.csv", samples_per_point, replicas, key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str());
-        datFile = fopen(filename, "w");
-        fprintf(datFile, "%12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s\n", 
+        sprintf(filename, "read.spp_%d.ks_%d_%d_%d%s.vs_%d_%d_%d%s.th_%d_%d_%d%s.csv", samples_per_point, key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), threads_start, threads_end, threads_points, threads_mode.c_str());
+        SweepJournal journal(filename, configHash, resume);
+        datFile = journal.openOutput();
+        PointMetrics metrics(&client, server_metrics, &journal,
+            {"KeySize", "ValueSize", "Threads"});
+        StageReport stageReport(&journal, {"KeySize", "ValueSize", "Threads"},
+            {"Send", "Response", "Complete"}, timetrace_every > 0);
+        fprintf(datFile, "%12s %12s %12s", 
             "KeySize",
             "ValueSize",
-            "1th",
-            "2th",
-            "5th",
-            "10th",
-            "25th",
-            "50th",
-            "75th",
-            "90th",
-            "95th",
-            "98th",
-            "99th");
+            "Threads");
+        LatencyHistogram::printHeader(datFile);
+        fprintf(datFile, " %12s %12s %12s %12s\n", 
+            "Ops/s",
+            "Bytes/s",
+            "Samples",
+            "CIWidth");
 
         for (int ks_idx = 0; ks_idx < key_sizes.size(); ks_idx++) {
           uint32_t key_size = key_sizes[ks_idx];
 
           for (int vs_idx = 0; vs_idx < value_sizes.size(); vs_idx++) {
             uint32_t value_size = value_sizes[vs_idx];
-            printf("Write Test: key_size: %dB, value_size: %dB\n", key_size, value_size);
 
-            char randomKey[key_size];
-            char randomValue[value_size];
+            for (int th_idx = 0; th_idx < thread_counts.size(); th_idx++) {
+              uint32_t thread_count = thread_counts[th_idx];
 
-            client.write(tableId, randomKey, key_size, randomValue, value_size);
+              if (journal.isDone({key_size, value_size, thread_count}))
+                continue;
+              trace.beginPoint(filename, {key_size, value_size, thread_count});
+              metrics.begin();
+              stageReport.begin();
+
+              printf("Read Test: key_size: %dB, value_size: %dB, threads: %d\n", key_size, value_size, thread_count);
+
+              // Each thread reads its own object and records its own samples.
+              std::vector<LatencyHistogram> threadHists(thread_count,
+                  LatencyHistogram(histogram_precision));
+              std::vector<StageBreakdown> threadStages(thread_count,
+                  StageBreakdown(timetrace_every, 3));
+              ClientThreads clientThreads(&client, &optionParser.options,
+                  thread_count);
+              clientThreads.run([&](RamCloud* threadClient, uint32_t threadIndex) {
+                char randomKey[key_size];
+                memset(randomKey, 0, key_size);
+                sprintf(randomKey, "%d", threadIndex);
+                const char* randomValue = arena.getValue();
+
+                threadClient->write(tableId, randomKey, key_size, randomValue, value_size);
+
+                Buffer value;
+                LatencyHistogram threadHist(histogram_precision);
+                StageBreakdown stages(timetrace_every, 3);
+                PointSampler sampler(samplingConfig, &threadHist,
+                    [&]() { clientThreads.start(); });
+                while (sampler.more()) {
+                  if (!sampler.warmingUp() && stages.sample()) {
+                    // Same read, timed stage by stage.
+                    uint64_t t[4];
+                    t[0] = Cycles::rdtsc();
+                    ReadRpc rpc(threadClient, tableId, randomKey, key_size, &value);
+                    t[1] = Cycles::rdtsc();
+                    while (!rpc.isReady())
+                      threadClient->poll();
+                    t[2] = Cycles::rdtsc();
+                    bool exists;
+                    rpc.wait(NULL, &exists);
+                    t[3] = Cycles::rdtsc();
+                    stages.record(t);
+                    sampler.record(Cycles::toNanoseconds(t[3]-t[0]));
+                    continue;
+                  }
 
-            uint64_t latency[samples_per_point];
-            for (int i = 0; i < samples_per_point; i++) {
-              bool exists;
-              uint64_t start = Cycles::rdtsc();
-              client.write(tableId, randomKey, key_size, randomValue, value_size);
-              uint64_t end = Cycles::rdtsc();
-              latency[i] = Cycles::toNanoseconds(end-start);
-            }
+                  bool exists;
+                  uint64_t start = Cycles::rdtsc();
+                  threadClient->read(tableId, randomKey, key_size, &value, NULL, NULL, &exists);
+                  uint64_t end = Cycles::rdtsc();
+                  sampler.record(Cycles::toNanoseconds(end-start));
+                }
+                clientThreads.stop();
+
+                // Recorded locally so threads never share cache lines while measuring.
+                threadHists[threadIndex] = threadHist;
+                threadStages[threadIndex] = stages;
+              });
+
+              LatencyHistogram latencyHist(histogram_precision);
+              StageBreakdown stages(timetrace_every, 3);
+              for (int t = 0; t < thread_count; t++) {
+                latencyHist.merge(threadHists[t]);
+                stages.merge(threadStages[t]);
+              }
+
+              uint64_t samples = latencyHist.getCount();
+              double opsPerSec = (double)samples / clientThreads.getElapsedSeconds();
+
+              fprintf(datFile, "%12d %12d %12d", 
+                  key_size,
+                  value_size,
+                  thread_count);
+              latencyHist.printPercentiles(datFile, 1000.0, 1);
+              fprintf(datFile, " %12.0f %12.4g %12lu %12.4f\n", 
+                  opsPerSec,
+                  opsPerSec * value_size,
+                  latencyHist.getCount(),
+                  PointSampler::getRelativeCIWidth(latencyHist, samplingConfig));
+              fflush(datFile);
+              metrics.end({key_size, value_size, thread_count});
+              stageReport.end({key_size, value_size, thread_count}, stages);
+              journal.markDone({key_size, value_size, thread_count});
+            } // th_idx
+          } // vs_idx
+        } // ks_idx
 
-            std::vector<uint64_t> latencyVec(latency, latency+samples_per_point);
+        fclose(datFile);
 
-            std::sort(latencyVec.begin(), latencyVec.end());
+        client.dropTable("test");
+      } else if (op.compare("write") == 0) {
+        uint64_t tableId = client.createTable("test");
+        RequestArena arena(0, value_size_max);
 
-            uint64_t sum = 0;
-            for (int i = 0; i < samples_per_point; i++) {
-              sum += latencyVec[i];
-            }
+        // Open data file for writing.
+        FILE * datFile;
+        char filename[512];
+        sprintf(filename, "write.spp_%d.rf_%d.ks_%d_%d_%d%s.vs_%d_%d_%d%s.th_%d_%d_%d%s.csv", samples_per_point, replicas, key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), threads_start, threads_end, threads_points, threads_mode.c_str());
+        SweepJournal journal(filename, configHash, resume);
+        datFile = journal.openOutput();
+        PointMetrics metrics(&client, server_metrics, &journal,
+            {"KeySize", "ValueSize", "Threads"});
+        fprintf(datFile, "%12s %12s %12s", 
+            "KeySize",
+            "ValueSize",
+            "Threads");
+        LatencyHistogram::printHeader(datFile);
+        fprintf(datFile, " %12s %12s %12s %12s\n", 
+            "Ops/s",
+            "Bytes/s",
+            "Samples",
+            "CIWidth");
 
-            fprintf(datFile, "%12d %12d %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n", 
-                key_size,
-                value_size,
-                latencyVec[samples_per_point*1/100]/1000.0,
-                latencyVec[samples_per_point*2/100]/1000.0,
-                latencyVec[samples_per_point*5/100]/1000.0,
-                latencyVec[samples_per_point*10/100]/1000.0,
-                latencyVec[samples_per_point*25/100]/1000.0,
-                latencyVec[samples_per_point*50/100]/1000.0,
-                latencyVec[samples_per_point*75/100]/1000.0,
-                latencyVec[samples_per_point*90/100]/1000.0,
-                latencyVec[samples_per_point*95/100]/1000.0,
-                latencyVec[samples_per_point*98/100]/1000.0,
-                latencyVec[samples_per_point*99/100]/1000.0);
-            fflush(datFile);
+        for (int ks_idx = 0; ks_idx < key_sizes.size(); ks_idx++) {
+          uint32_t key_size = key_sizes[ks_idx];
+
+          for (int vs_idx = 0; vs_idx < value_sizes.size(); vs_idx++) {
+            uint32_t value_size = value_sizes[vs_idx];
+
+            for (int th_idx = 0; th_idx < thread_counts.size(); th_idx++) {
+              uint32_t thread_count = thread_counts[th_idx];
+
+              if (journal.isDone({key_size, value_size, thread_count}))
+                continue;
+              trace.beginPoint(filename, {key_size, value_size, thread_count});
+              metrics.begin();
+
+              printf("Write Test: key_size: %dB, value_size: %dB, threads: %d\n", key_size, value_size, thread_count);
+
+              // Each thread writes its own object and records its own samples.
+              std::vector<LatencyHistogram> threadHists(thread_count,
+                  LatencyHistogram(histogram_precision));
+              ClientThreads clientThreads(&client, &optionParser.options,
+                  thread_count);
+              clientThreads.run([&](RamCloud* threadClient, uint32_t threadIndex) {
+                char randomKey[key_size];
+                memset(randomKey, 0, key_size);
+                sprintf(randomKey, "%d", threadIndex);
+                const char* randomValue = arena.getValue();
+
+                threadClient->write(tableId, randomKey, key_size, randomValue, value_size);
+
+                LatencyHistogram threadHist(histogram_precision);
+                PointSampler sampler(samplingConfig, &threadHist,
+                    [&]() { clientThreads.start(); });
+                while (sampler.more()) {
+                  uint64_t start = Cycles::rdtsc();
+                  threadClient->write(tableId, randomKey, key_size, randomValue, value_size);
+                  uint64_t end = Cycles::rdtsc();
+                  sampler.record(Cycles::toNanoseconds(end-start));
+                }
+                clientThreads.stop();
+
+                // Recorded locally so threads never share cache lines while measuring.
+                threadHists[threadIndex] = threadHist;
+              });
+
+              LatencyHistogram latencyHist(histogram_precision);
+              for (int t = 0; t < thread_count; t++)
+                latencyHist.merge(threadHists[t]);
+
+              uint64_t samples = latencyHist.getCount();
+              double opsPerSec = (double)samples / clientThreads.getElapsedSeconds();
+
+              fprintf(datFile, "%12d %12d %12d", 
+                  key_size,
+                  value_size,
+                  thread_count);
+              latencyHist.printPercentiles(datFile, 1000.0, 1);
+              fprintf(datFile, " %12.0f %12.4g %12lu %12.4f\n", 
+                  opsPerSec,
+                  opsPerSec * value_size,
+                  latencyHist.getCount(),
+                  PointSampler::getRelativeCIWidth(latencyHist, samplingConfig));
+              fflush(datFile);
+              metrics.end({key_size, value_size, thread_count});
+              journal.markDone({key_size, value_size, thread_count});
+            } // th_idx
           } // vs_idx
         } // ks_idx
 
@@ -634,357 +1554,514 @@ try
         // Open data file for writing.
         FILE * datFile;
         char filename[512];
-        sprintf(filename, "multiread.spp_%d.ss_%d_%d_%d%s.ks_%d_%d_%d%s.vs_%d_%d_%d%s.ms_%d_%d_%d%s.csv", samples_per_point, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), multi_size_start, multi_size_end, multi_size_points, multi_size_mode.c_str());
-        datFile = fopen(filename, "w");
-        fprintf(datFile, "%12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s\n", 
+        sprintf(filename, "multiread.spp_%d.ss_%d_%d_%d%s.ks_%d_%d_%d%s.vs_%d_%d_%d%s.ms_%d_%d_%d%s.th_%d_%d_%d%s.csv", samples_per_point, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), multi_size_start, multi_size_end, multi_size_points, multi_size_mode.c_str(), threads_start, threads_end, threads_points, threads_mode.c_str());
+        SweepJournal journal(filename, configHash, resume);
+        datFile = journal.openOutput();
+        PointMetrics metrics(&client, server_metrics, &journal,
+            {"ServerSize", "KeySize", "ValueSize", "MultiSize", "Threads"});
+        StageReport stageReport(&journal,
+            {"ServerSize", "KeySize", "ValueSize", "MultiSize", "Threads"},
+            {"Send", "Response", "Complete"}, timetrace_every > 0);
+        fprintf(datFile, "%12s %12s %12s %12s %12s", 
             "ServerSize",
             "KeySize",
             "ValueSize",
             "MultiSize",
-            "1th",
-            "2th",
-            "5th",
-            "10th",
-            "25th",
-            "50th",
-            "75th",
-            "90th",
-            "95th",
-            "98th",
-            "99th");
-
-        for (int sv_idx = 0; sv_idx < server_sizes.size(); sv_idx++) {
-          uint32_t server_size = server_sizes[sv_idx];
-
-          uint64_t tableId = client.createTable("test", server_size);
-
-          // Calculate hash ranges.
-          uint64_t endKeyHashes[server_size];
-          uint64_t tabletRange = 1 + ~0UL / server_size;
-          for (uint32_t i = 0; i < server_size; i++) {
-            uint64_t startKeyHash = i * tabletRange;
-            uint64_t endKeyHash = startKeyHash + tabletRange - 1;
-            if (i == (server_size - 1))
-              endKeyHash = ~0UL;
-
-            endKeyHashes[i] = endKeyHash;
-          }
+            "Threads");
+        LatencyHistogram::printHeader(datFile);
+        fprintf(datFile, " %12s %12s %12s %12s\n", 
+            "Objs/s",
+            "Bytes/s",
+            "Samples",
+            "CIWidth");
+
+        // Start with the server span and value sizes that are already
+        // loaded, if any.
+        std::vector<uint32_t> sv_order = planner.orderServerSizes(server_sizes);
+        for (int sv_idx = 0; sv_idx < sv_order.size(); sv_idx++) {
+          uint32_t server_size = sv_order[sv_idx];
+
+          uint64_t tableId = planner.getTable(server_size);
+          BulkLoader loader(&client, load_batch_size, load_pipeline_depth);
+          RequestArena arena(threads_max * multi_size_max, value_size_max);
 
           for (int ks_idx = 0; ks_idx < key_sizes.size(); ks_idx++) {
             uint32_t key_size = key_sizes[ks_idx];
 
-            // Construct keys.
-            char keys[multi_size_max][key_size];
-            memset(keys, 0, multi_size_max * key_size);
-            uint32_t key_candidate = 0;
-            uint32_t n = 0;
-            while (n < multi_size_max) {
-              sprintf(keys[n], "%d", key_candidate);
-
-              // Find the tablet this key belongs to.
-              uint64_t keyHash = Key::getHash(tableId, (const void*)keys[n],
-                  (uint16_t)key_size);
-              uint64_t tablet = 0;
-              for (uint32_t j = 0; j < server_size; j++) {
-                if (keyHash <= endKeyHashes[j]) {
-                  tablet = j;
-                  break;
-                }
-              }
-              
-              if (tablet == n % server_size) {
-                n++;
-              }
+            // Construct keys. Each thread gets its own multi_size_max keys.
+            uint32_t key_count = threads_max * multi_size_max;
+            KeySet keySet(tableId, server_size, key_size, key_count,
+                keyCacheDir);
+            const char* keyBase = keySet.getKeys();
 
-              key_candidate++;
-            }
+            std::vector<uint32_t> vs_order = planner.orderValueSizes(key_size,
+                value_sizes);
+            for (int vs_idx = 0; vs_idx < vs_order.size(); vs_idx++) {
+              uint32_t value_size = vs_order[vs_idx];
 
-            for (int vs_idx = 0; vs_idx < value_sizes.size(); vs_idx++) {
-              uint32_t value_size = value_sizes[vs_idx];
+              // Nothing to load if every point using this dataset is done.
+              if (journal.isDone({server_size, key_size, value_size},
+                  {multi_sizes, thread_counts}))
+                continue;
 
               // Write value_size data into objects.
-              for (int i = 0; i < multi_size_max; i++) {
-                char randomValue[value_size];
-                client.write(tableId, keys[i], key_size, randomValue, value_size);
-              }
+              planner.load(&loader, keyBase, key_size, key_count,
+                  arena.getValue(), value_size);
 
               for (int ms_idx = 0; ms_idx < multi_sizes.size(); ms_idx++) {
                 uint32_t multi_size = multi_sizes[ms_idx];
 
-                printf("Multiread Test: server_size: %d, key_size: %dB, value_size: %dB, multi_size: %d\n", server_size, key_size, value_size, multi_size);
-
-                // Prepare multiread data structures.
-                MultiReadObject requestObjects[multi_size];
-                MultiReadObject* requests[multi_size];
-                Tub<ObjectBuffer> values[multi_size];
-
-                for (int i = 0; i < multi_size; i++) {
-                  requestObjects[i] = MultiReadObject(tableId, keys[i], 
-                      key_size, &values[i]);
-                  requests[i] = &requestObjects[i];
-                }
-
-                uint64_t latency[samples_per_point];
-                for (int i = 0; i < samples_per_point; i++) {
-                  uint64_t start = Cycles::rdtsc();
-                  client.multiRead(requests, multi_size);
-                  uint64_t end = Cycles::rdtsc();
-                  latency[i] = Cycles::toNanoseconds(end-start);
-                }
+                for (int th_idx = 0; th_idx < thread_counts.size(); th_idx++) {
+                  uint32_t thread_count = thread_counts[th_idx];
+
+                  if (journal.isDone({server_size, key_size, value_size, multi_size, thread_count}))
+                    continue;
+                  trace.beginPoint(filename, {server_size, key_size, value_size, multi_size, thread_count});
+                  metrics.begin();
+                  stageReport.begin();
+
+                  printf("Multiread Test: server_size: %d, key_size: %dB, value_size: %dB, multi_size: %d, threads: %d\n", server_size, key_size, value_size, multi_size, thread_count);
+
+                  std::vector<LatencyHistogram> threadHists(thread_count,
+                  LatencyHistogram(histogram_precision));
+                  std::vector<StageBreakdown> threadStages(thread_count,
+                      StageBreakdown(timetrace_every, 3));
+                  ClientThreads clientThreads(&client, &optionParser.options,
+                      thread_count);
+                  clientThreads.run([&](RamCloud* threadClient, uint32_t threadIndex) {
+                    const char* threadKeys = keyBase + 
+                        (uint64_t)threadIndex * multi_size_max * key_size;
+
+                    // Prepare multiread data structures in this thread's
+                    // slice of the arena.
+                    MultiReadObject** requests = arena.prepare(
+                        threadIndex * multi_size_max, tableId, threadKeys,
+                        key_size, multi_size);
+
+                    // Untimed, so that fetching the tablet map and opening
+                    // sessions to the masters isn't part of any sample.
+                    threadClient->multiRead(requests, multi_size);
+
+                    LatencyHistogram threadHist(histogram_precision);
+                    StageBreakdown stages(timetrace_every, 3);
+                    PointSampler sampler(samplingConfig, &threadHist,
+                        [&]() { clientThreads.start(); });
+                    while (sampler.more()) {
+                      if (!sampler.warmingUp() && stages.sample()) {
+                        // Same multiread, timed stage by stage.
+                        uint64_t t[4];
+                        t[0] = Cycles::rdtsc();
+                        MultiRead request(threadClient, requests, multi_size);
+                        t[1] = Cycles::rdtsc();
+                        while (!request.isReady())
+                          threadClient->poll();
+                        t[2] = Cycles::rdtsc();
+                        request.wait();
+                        t[3] = Cycles::rdtsc();
+                        stages.record(t);
+                        sampler.record(Cycles::toNanoseconds(t[3]-t[0]));
+                        continue;
+                      }
 
-                std::vector<uint64_t> latencyVec(latency, latency+samples_per_point);
+                      uint64_t start = Cycles::rdtsc();
+                      threadClient->multiRead(requests, multi_size);
+                      uint64_t end = Cycles::rdtsc();
+                      sampler.record(Cycles::toNanoseconds(end-start));
+                    }
+                    clientThreads.stop();
+
+                    // Recorded locally so threads never share cache lines while measuring.
+                    threadHists[threadIndex] = threadHist;
+                    threadStages[threadIndex] = stages;
+                  });
+
+                  LatencyHistogram latencyHist(histogram_precision);
+                  StageBreakdown stages(timetrace_every, 3);
+                  for (int t = 0; t < thread_count; t++) {
+                    latencyHist.merge(threadHists[t]);
+                    stages.merge(threadStages[t]);
+                  }
 
-                std::sort(latencyVec.begin(), latencyVec.end());
+                  uint64_t samples = latencyHist.getCount();
+                  double objsPerSec = (double)samples * multi_size / clientThreads.getElapsedSeconds();
 
-                uint64_t sum = 0;
-                for (int i = 0; i < samples_per_point; i++) {
-                  sum += latencyVec[i];
-                }
-
-                fprintf(datFile, "%12d %12d %12d %12d %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f\n", 
-                    server_size,
-                    key_size,
-                    value_size,
-                    multi_size,
-                    latencyVec[samples_per_point*1/100]/1000.0/multi_size,
-                    latencyVec[samples_per_point*2/100]/1000.0/multi_size,
-                    latencyVec[samples_per_point*5/100]/1000.0/multi_size,
-                    latencyVec[samples_per_point*10/100]/1000.0/multi_size,
-                    latencyVec[samples_per_point*25/100]/1000.0/multi_size,
-                    latencyVec[samples_per_point*50/100]/1000.0/multi_size,
-                    latencyVec[samples_per_point*75/100]/1000.0/multi_size,
-                    latencyVec[samples_per_point*90/100]/1000.0/multi_size,
-                    latencyVec[samples_per_point*95/100]/1000.0/multi_size,
-                    latencyVec[samples_per_point*98/100]/1000.0/multi_size,
-                    latencyVec[samples_per_point*99/100]/1000.0/multi_size);
-                fflush(datFile);
+                  fprintf(datFile, "%12d %12d %12d %12d %12d", 
+                      server_size,
+                      key_size,
+                      value_size,
+                      multi_size,
+                      thread_count);
+                  latencyHist.printPercentiles(datFile, 1000.0 * multi_size, 3);
+                  fprintf(datFile, " %12.0f %12.4g %12lu %12.4f\n", 
+                      objsPerSec,
+                      objsPerSec * value_size,
+                      latencyHist.getCount(),
+                      PointSampler::getRelativeCIWidth(latencyHist, samplingConfig));
+                  fflush(datFile);
+                  metrics.end({server_size, key_size, value_size, multi_size, thread_count});
+                  stageReport.end({server_size, key_size, value_size, multi_size, thread_count}, stages);
+                  journal.markDone({server_size, key_size, value_size, multi_size, thread_count});
+                } // th_idx
               } // ms_idx
             } // vs_idx
           } // ks_idx
-
-          client.dropTable("test");
         } // sv_idx
 
         fclose(datFile);
-      } else if (op.compare("multiread_fixeddss") == 0) {
+        planner.printSummary(op.c_str());
+      } else if (op.compare("multiwrite") == 0 ||
+          op.compare("multiremove") == 0 ||
+          op.compare("multiincrement") == 0) {
+        bool isRemove = (op.compare("multiremove") == 0);
+        bool isIncrement = (op.compare("multiincrement") == 0);
+
+        // Increments need 8 byte integer values.
+        std::vector<uint32_t> op_value_sizes = value_sizes;
+        if (isIncrement)
+          op_value_sizes = std::vector<uint32_t>(1, sizeof(int64_t));
+
         // Open data file for writing.
         FILE * datFile;
         char filename[512];
-        sprintf(filename, "multiread_fixeddss.spp_%d.ss_%d_%d_%d%s.ds_%d_%d_%d%s.ms_%d_%d_%d%s.csv", samples_per_point, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), ds_size_start, ds_size_end, ds_size_points, ds_size_mode.c_str(), multi_size_start, multi_size_end, multi_size_points, multi_size_mode.c_str());
-        datFile = fopen(filename, "w");
-        fprintf(datFile, "%12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s\n",
+        sprintf(filename, "%s.spp_%d.rf_%d.ss_%d_%d_%d%s.ks_%d_%d_%d%s.vs_%d_%d_%d%s.ms_%d_%d_%d%s.th_%d_%d_%d%s.csv", op.c_str(), samples_per_point, replicas, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), multi_size_start, multi_size_end, multi_size_points, multi_size_mode.c_str(), threads_start, threads_end, threads_points, threads_mode.c_str());
+        SweepJournal journal(filename, configHash, resume);
+        datFile = journal.openOutput();
+        PointMetrics metrics(&client, server_metrics, &journal,
+            {"ServerSize", "KeySize", "ValueSize", "MultiSize", "Threads"});
+        fprintf(datFile, "%12s %12s %12s %12s %12s", 
             "ServerSize",
-            "DatasetSize",
+            "KeySize",
+            "ValueSize",
             "MultiSize",
-            "1th",
-            "2th",
-            "5th",
-            "10th",
-            "25th",
-            "50th",
-            "75th",
-            "90th",
-            "95th",
-            "98th",
-            "99th");
+            "Threads");
+        LatencyHistogram::printHeader(datFile);
+        fprintf(datFile, " %12s %12s", 
+            "Objs/s",
+            "Bytes/s");
+        LatencyHistogram::printHeader(datFile, "Batch");
+        fprintf(datFile, " %12s %12s\n", 
+            "Samples",
+            "CIWidth");
 
         for (int sv_idx = 0; sv_idx < server_sizes.size(); sv_idx++) {
           uint32_t server_size = server_sizes[sv_idx];
 
           uint64_t tableId = client.createTable("test", server_size);
+          BulkLoader loader(&client, load_batch_size, load_pipeline_depth);
+          RequestArena arena(0, value_size_max);
 
-          // Calculate hash ranges.
-          uint64_t endKeyHashes[server_size];
-          uint64_t tabletRange = 1 + ~0UL / server_size;
-          for (uint32_t i = 0; i < server_size; i++) {
-            uint64_t startKeyHash = i * tabletRange;
-            uint64_t endKeyHash = startKeyHash + tabletRange - 1;
-            if (i == (server_size - 1))
-              endKeyHash = ~0UL;
-
-            endKeyHashes[i] = endKeyHash;
-          }
-
-          for (int dss_idx = 0; dss_idx < ds_sizes.size(); dss_idx++) {
-            uint32_t ds_size = ds_sizes[dss_idx];
-
-            for (int ms_idx = 0; ms_idx < multi_sizes.size(); ms_idx++) {
-              uint32_t multi_size = multi_sizes[ms_idx];
+          for (int ks_idx = 0; ks_idx < key_sizes.size(); ks_idx++) {
+            uint32_t key_size = key_sizes[ks_idx];
 
-              printf("Multiread Fixed DSS Test: server_size: %d, ds_size: %d, multi_size: %d\n", server_size, ds_size, multi_size);
+            // Construct keys. Each thread gets its own multi_size_max keys.
+            uint32_t key_count = threads_max * multi_size_max;
+            KeySet keySet(tableId, server_size, key_size, key_count,
+                keyCacheDir);
+            const char* keyBase = keySet.getKeys();
 
-              // Compute value_size.
-              uint32_t key_size = 30; // Use fixed 30B keys.
+            for (int vs_idx = 0; vs_idx < op_value_sizes.size(); vs_idx++) {
+              uint32_t value_size = op_value_sizes[vs_idx];
 
-              // Check to make sure that we have room left for value bytes.
-              if (key_size * multi_size > ds_size) {
-                printf("WARNING: Unsatisfiable parameter values (ds_size=%d, multi_size=%d). Not enough dataset bytes for values: (key_size=%d * multi_size=%d) > ds_size=%d. Skipping this parameter configuration.\n", ds_size, multi_size, key_size, multi_size, ds_size);
+              // Nothing to load if every point using this dataset is done.
+              if (journal.isDone({server_size, key_size, value_size},
+                  {multi_sizes, thread_counts}))
                 continue;
-              }
-
-              uint32_t value_size = (ds_size - (key_size * multi_size)) / multi_size;
 
-              // Construct keys.
-              char keys[multi_size][key_size];
-              memset(keys, 0, multi_size * key_size);
-              uint32_t key_candidate = 0;
-              uint32_t n = 0;
-              while (n < multi_size) {
-                sprintf(keys[n], "%d", key_candidate);
-
-                // Find the tablet this key belongs to.
-                uint64_t keyHash = Key::getHash(tableId, (const void*)keys[n],
-                    (uint16_t)key_size);
-                uint64_t tablet = 0;
-                for (uint32_t j = 0; j < server_size; j++) {
-                  if (keyHash <= endKeyHashes[j]) {
-                    tablet = j;
-                    break;
-                  }
-                }
+              // Write value_size data into objects. Writes don't need the
+              // objects to exist, but this keeps every sample an overwrite.
+              loader.load(tableId, keyBase, key_size, key_count,
+                  arena.getValue(), value_size);
 
-                if (tablet == n % server_size) {
-                  n++;
-                }
-
-                key_candidate++;
-              }
-
-              // Write value_size data into objects.
-              for (int i = 0; i < multi_size; i++) {
-                char randomValue[value_size];
-                client.write(tableId, keys[i], key_size, randomValue, value_size);
-              }
+              for (int ms_idx = 0; ms_idx < multi_sizes.size(); ms_idx++) {
+                uint32_t multi_size = multi_sizes[ms_idx];
 
-              // Prepare multiread data structures.
-              MultiReadObject requestObjects[multi_size];
-              MultiReadObject* requests[multi_size];
-              Tub<ObjectBuffer> values[multi_size];
+                for (int th_idx = 0; th_idx < thread_counts.size(); th_idx++) {
+                  uint32_t thread_count = thread_counts[th_idx];
+
+                  if (journal.isDone({server_size, key_size, value_size, multi_size, thread_count}))
+                    continue;
+                  trace.beginPoint(filename, {server_size, key_size, value_size, multi_size, thread_count});
+                  metrics.begin();
+
+                  printf("%s Test: server_size: %d, key_size: %dB, value_size: %dB, multi_size: %d, threads: %d\n", op.c_str(), server_size, key_size, value_size, multi_size, thread_count);
+
+                  std::vector<LatencyHistogram> threadHists(thread_count,
+                      LatencyHistogram(histogram_precision));
+                  ClientThreads clientThreads(&client, &optionParser.options,
+                      thread_count);
+                  clientThreads.run([&](RamCloud* threadClient, uint32_t threadIndex) {
+                    const char* threadKeys = keyBase + 
+                        (uint64_t)threadIndex * multi_size_max * key_size;
+
+                    // Prepare request data structures. Removes also need
+                    // writes to put the objects back between samples.
+                    std::vector<MultiWriteObject> writeObjects(multi_size);
+                    std::vector<MultiWriteObject*> writeRequests(multi_size);
+                    std::vector<MultiRemoveObject> removeObjects;
+                    std::vector<MultiRemoveObject*> removeRequests;
+                    std::vector<MultiIncrementObject> incrementObjects;
+                    std::vector<MultiIncrementObject*> incrementRequests;
+                    if (isRemove) {
+                      removeObjects.resize(multi_size);
+                      removeRequests.resize(multi_size);
+                    }
+                    if (isIncrement) {
+                      incrementObjects.resize(multi_size);
+                      incrementRequests.resize(multi_size);
+                    }
 
-              for (int i = 0; i < multi_size; i++) {
-                requestObjects[i] = MultiReadObject(tableId, keys[i], 
-                    key_size, &values[i]);
-                requests[i] = &requestObjects[i];
-              }
+                    for (int i = 0; i < multi_size; i++) {
+                      const char* key = threadKeys + (uint64_t)i * key_size;
+                      writeObjects[i] = MultiWriteObject(tableId, key,
+                          key_size, arena.getValue(), value_size);
+                      writeRequests[i] = &writeObjects[i];
+                      if (isRemove) {
+                        removeObjects[i] = MultiRemoveObject(tableId, key,
+                            key_size);
+                        removeRequests[i] = &removeObjects[i];
+                      }
+                      if (isIncrement) {
+                        incrementObjects[i] = MultiIncrementObject(tableId,
+                            key, key_size, 1, 0.0);
+                        incrementRequests[i] = &incrementObjects[i];
+                      }
+                    }
 
-              uint64_t latency[samples_per_point];
-              for (int i = 0; i < samples_per_point; i++) {
-                uint64_t start = Cycles::rdtsc();
-                client.multiRead(requests, multi_size);
-                uint64_t end = Cycles::rdtsc();
-                latency[i] = Cycles::toNanoseconds(end-start);
-              }
+                    // Untimed, so that fetching the tablet map and opening
+                    // sessions to the masters isn't part of any sample. It
+                    // also puts the objects in place for removes.
+                    threadClient->multiWrite(&writeRequests[0], multi_size);
+
+                    LatencyHistogram threadHist(histogram_precision);
+                    PointSampler sampler(samplingConfig, &threadHist,
+                        [&]() { clientThreads.start(); });
+                    while (sampler.more()) {
+                      uint64_t start = Cycles::rdtsc();
+                      if (isRemove)
+                        threadClient->multiRemove(&removeRequests[0], multi_size);
+                      else if (isIncrement)
+                        threadClient->multiIncrement(&incrementRequests[0], multi_size);
+                      else
+                        threadClient->multiWrite(&writeRequests[0], multi_size);
+                      uint64_t end = Cycles::rdtsc();
+                      sampler.record(Cycles::toNanoseconds(end-start));
+
+                      if (isRemove)
+                        threadClient->multiWrite(&writeRequests[0], multi_size);
+                    }
+                    clientThreads.stop();
+
+                    // Recorded locally so threads never share cache lines while measuring.
+                    threadHists[threadIndex] = threadHist;
+                  });
+
+                  LatencyHistogram latencyHist(histogram_precision);
+                  for (int t = 0; t < thread_count; t++)
+                    latencyHist.merge(threadHists[t]);
+
+                  // Removes spend part of their wall time rewriting objects,
+                  // so their throughput comes from the timed operations only.
+                  uint64_t samples = latencyHist.getCount();
+                  double objsPerSec;
+                  if (isRemove)
+                    objsPerSec = (double)multi_size * thread_count / (latencyHist.getMean() / 1e9);
+                  else
+                    objsPerSec = (double)samples * multi_size / clientThreads.getElapsedSeconds();
+
+                  fprintf(datFile, "%12d %12d %12d %12d %12d", 
+                      server_size,
+                      key_size,
+                      value_size,
+                      multi_size,
+                      thread_count);
+                  latencyHist.printPercentiles(datFile, 1000.0 * multi_size, 3);
+                  fprintf(datFile, " %12.0f %12.4g", 
+                      objsPerSec,
+                      objsPerSec * value_size);
+                  latencyHist.printPercentiles(datFile, 1000.0, 1);
+                  fprintf(datFile, " %12lu %12.4f\n", 
+                      latencyHist.getCount(),
+                      PointSampler::getRelativeCIWidth(latencyHist, samplingConfig));
+                  fflush(datFile);
+                  metrics.end({server_size, key_size, value_size, multi_size, thread_count});
+                  journal.markDone({server_size, key_size, value_size, multi_size, thread_count});
+                } // th_idx
+              } // ms_idx
+            } // vs_idx
+          } // ks_idx
 
-              std::vector<uint64_t> latencyVec(latency, latency+samples_per_point);
+          client.dropTable("test");
+        } // sv_idx
 
-              std::sort(latencyVec.begin(), latencyVec.end());
+        fclose(datFile);
+      } else if (op.compare("multiread_fixeddss") == 0) {
+        // Open data file for writing.
+        FILE * datFile;
+        char filename[512];
+        sprintf(filename, "multiread_fixeddss.spp_%d.ss_%d_%d_%d%s.ds_%d_%d_%d%s.ms_%d_%d_%d%s.csv", samples_per_point, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), ds_size_start, ds_size_end, ds_size_points, ds_size_mode.c_str(), multi_size_start, multi_size_end, multi_size_points, multi_size_mode.c_str());
+        SweepJournal journal(filename, configHash, resume);
+        datFile = journal.openOutput();
+        PointMetrics metrics(&client, server_metrics, &journal,
+            {"ServerSize", "DatasetSize", "MultiSize"});
+        fprintf(datFile, "%12s %12s %12s", 
+            "ServerSize",
+            "DatasetSize",
+            "MultiSize");
+        LatencyHistogram::printHeader(datFile);
+        fprintf(datFile, " %12s %12s\n", 
+            "Samples",
+            "CIWidth");
+
+        // Every point reads a prefix of the same 30B key set, and points
+        // whose values come out the same size can share one dataset. Visit
+        // those together, in increasing multi_size order, so each dataset is
+        // loaded once and only ever grows.
+        uint32_t key_size = 30; // Use fixed 30B keys.
+        struct FixedDssPoint {
+          uint32_t ds_size;
+          uint32_t multi_size;
+          uint32_t value_size;
+        };
+        std::vector<FixedDssPoint> points;
+        for (int dss_idx = 0; dss_idx < ds_sizes.size(); dss_idx++) {
+          uint32_t ds_size = ds_sizes[dss_idx];
+
+          for (int ms_idx = 0; ms_idx < multi_sizes.size(); ms_idx++) {
+            uint32_t multi_size = multi_sizes[ms_idx];
+
+            // Check to make sure that we have room left for value bytes.
+            if (key_size * multi_size > ds_size) {
+              printf("WARNING: Unsatisfiable parameter values (ds_size=%d, multi_size=%d). Not enough dataset bytes for values: (key_size=%d * multi_size=%d) > ds_size=%d. Skipping this parameter configuration.\n", ds_size, multi_size, key_size, multi_size, ds_size);
+              continue;
+            }
 
-              uint64_t sum = 0;
-              for (int i = 0; i < samples_per_point; i++) {
-                sum += latencyVec[i];
-              }
+            // Compute value_size.
+            uint32_t value_size = (ds_size - (key_size * multi_size)) / multi_size;
 
-              fprintf(datFile, "%12d %12d %12d %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n", 
-                  server_size,
-                  ds_size,
-                  multi_size,
-                  latencyVec[samples_per_point*1/100]/1000.0,
-                  latencyVec[samples_per_point*2/100]/1000.0,
-                  latencyVec[samples_per_point*5/100]/1000.0,
-                  latencyVec[samples_per_point*10/100]/1000.0,
-                  latencyVec[samples_per_point*25/100]/1000.0,
-                  latencyVec[samples_per_point*50/100]/1000.0,
-                  latencyVec[samples_per_point*75/100]/1000.0,
-                  latencyVec[samples_per_point*90/100]/1000.0,
-                  latencyVec[samples_per_point*95/100]/1000.0,
-                  latencyVec[samples_per_point*98/100]/1000.0,
-                  latencyVec[samples_per_point*99/100]/1000.0);
-              fflush(datFile);
-            } // ms_idx
-          } // dss_idx
+            FixedDssPoint point = {ds_size, multi_size, value_size};
+            points.push_back(point);
+          }
+        }
+        std::stable_sort(points.begin(), points.end(),
+            [](const FixedDssPoint& a, const FixedDssPoint& b) {
+              if (a.value_size != b.value_size)
+                return a.value_size < b.value_size;
+              return a.multi_size < b.multi_size;
+            });
+
+        std::vector<uint32_t> sv_order = planner.orderServerSizes(server_sizes);
+        for (int sv_idx = 0; sv_idx < sv_order.size(); sv_idx++) {
+          uint32_t server_size = sv_order[sv_idx];
+
+          uint64_t tableId = planner.getTable(server_size);
+          BulkLoader loader(&client, load_batch_size, load_pipeline_depth);
+          RequestArena arena(multi_size_max, ds_size_max);
+
+          // Construct keys.
+          KeySet keySet(tableId, server_size, key_size, multi_size_max,
+              keyCacheDir);
+
+          // Start with the points whose dataset is already loaded.
+          std::stable_partition(points.begin(), points.end(),
+              [&](const FixedDssPoint& point) {
+                return planner.isResident(key_size, point.value_size);
+              });
+
+          for (int pt_idx = 0; pt_idx < points.size(); pt_idx++) {
+            uint32_t ds_size = points[pt_idx].ds_size;
+            uint32_t multi_size = points[pt_idx].multi_size;
+            uint32_t value_size = points[pt_idx].value_size;
+
+            if (journal.isDone({server_size, ds_size, multi_size}))
+              continue;
+            trace.beginPoint(filename, {server_size, ds_size, multi_size});
+            metrics.begin();
+
+            printf("Multiread Fixed DSS Test: server_size: %d, ds_size: %d, multi_size: %d\n", server_size, ds_size, multi_size);
+
+            // Write value_size data into any objects not already loaded.
+            planner.load(&loader, keySet.getKeys(), key_size, multi_size,
+                arena.getValue(), value_size);
+
+            // Prepare multiread data structures.
+            MultiReadObject** requests = arena.prepare(0, tableId,
+                keySet.getKeys(), key_size, multi_size);
+
+            LatencyHistogram latencyHist(histogram_precision);
+            PointSampler sampler(samplingConfig, &latencyHist);
+            while (sampler.more()) {
+              uint64_t start = Cycles::rdtsc();
+              client.multiRead(requests, multi_size);
+              uint64_t end = Cycles::rdtsc();
+              sampler.record(Cycles::toNanoseconds(end-start));
+            }
 
-          client.dropTable("test");
+            fprintf(datFile, "%12d %12d %12d", 
+                server_size,
+                ds_size,
+                multi_size);
+            latencyHist.printPercentiles(datFile, 1000.0, 1);
+            fprintf(datFile, " %12lu %12.4f\n", 
+                latencyHist.getCount(),
+                PointSampler::getRelativeCIWidth(latencyHist, samplingConfig));
+            fflush(datFile);
+            metrics.end({server_size, ds_size, multi_size});
+            journal.markDone({server_size, ds_size, multi_size});
+          } // pt_idx
         } // sv_idx
 
         fclose(datFile);
+        planner.printSummary(op.c_str());
       } else if (op.compare("multiread_fixeddss_chunked") == 0) {
         // Open data file for writing.
         FILE * datFile;
         char filename[512];
         sprintf(filename, "multiread_fixeddss_chunked.spp_%d.ss_%d_%d_%d%s.ks_%d_%d_%d%s.vs_%d_%d_%d%s.ds_%d_%d_%d%s.ms_%d_%d_%d%s.csv", samples_per_point, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), ds_size_start, ds_size_end, ds_size_points, ds_size_mode.c_str(), multi_size_start, multi_size_end, multi_size_points, multi_size_mode.c_str());
-        datFile = fopen(filename, "w");
-        fprintf(datFile, "%12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s\n", 
+        SweepJournal journal(filename, configHash, resume);
+        datFile = journal.openOutput();
+        PointMetrics metrics(&client, server_metrics, &journal,
+            {"ServerSize", "KeySize", "ValueSize", "DatasetSize", "MultiSize"});
+        fprintf(datFile, "%12s %12s %12s %12s %12s", 
             "ServerSize",
             "KeySize",
             "ValueSize",
             "DatasetSize",
-            "MultiSize",
-            "1th",
-            "2th",
-            "5th",
-            "10th",
-            "25th",
-            "50th",
-            "75th",
-            "90th",
-            "95th",
-            "98th",
-            "99th");
-
-        for (int sv_idx = 0; sv_idx < server_sizes.size(); sv_idx++) {
-          uint32_t server_size = server_sizes[sv_idx];
-
-          uint64_t tableId = client.createTable("test", server_size);
-
-          // Calculate hash ranges.
-          uint64_t endKeyHashes[server_size];
-          uint64_t tabletRange = 1 + ~0UL / server_size;
-          for (uint32_t i = 0; i < server_size; i++) {
-            uint64_t startKeyHash = i * tabletRange;
-            uint64_t endKeyHash = startKeyHash + tabletRange - 1;
-            if (i == (server_size - 1))
-              endKeyHash = ~0UL;
-
-            endKeyHashes[i] = endKeyHash;
-          }
+            "MultiSize");
+        LatencyHistogram::printHeader(datFile);
+        fprintf(datFile, " %12s %12s\n", 
+            "Samples",
+            "CIWidth");
+
+        // Start with the server span and value sizes that are already
+        // loaded, if any.
+        std::vector<uint32_t> sv_order = planner.orderServerSizes(server_sizes);
+        for (int sv_idx = 0; sv_idx < sv_order.size(); sv_idx++) {
+          uint32_t server_size = sv_order[sv_idx];
+
+          uint64_t tableId = planner.getTable(server_size);
+          BulkLoader loader(&client, load_batch_size, load_pipeline_depth);
+          RequestArena arena(multi_size_max, value_size_max);
 
           for (int ks_idx = 0; ks_idx < key_sizes.size(); ks_idx++) {
             uint32_t key_size = key_sizes[ks_idx];
 
             // Construct keys.
-            char keys[ds_size_max][key_size];
-            memset(keys, 0, ds_size_max * key_size);
-            uint32_t key_candidate = 0;
-            uint32_t n = 0;
-            while (n < ds_size_max) {
-              sprintf(keys[n], "%d", key_candidate);
-
-              // Find the tablet this key belongs to.
-              uint64_t keyHash = Key::getHash(tableId, (const void*)keys[n],
-                  (uint16_t)key_size);
-              uint64_t tablet = 0;
-              for (uint32_t j = 0; j < server_size; j++) {
-                if (keyHash <= endKeyHashes[j]) {
-                  tablet = j;
-                  break;
-                }
-              }
-              
-              if (tablet == n % server_size) {
-                n++;
-              }
+            KeySet keySet(tableId, server_size, key_size, ds_size_max,
+                keyCacheDir);
 
-              key_candidate++;
-            }
+            std::vector<uint32_t> vs_order = planner.orderValueSizes(key_size,
+                value_sizes);
+            for (int vs_idx = 0; vs_idx < vs_order.size(); vs_idx++) {
+              uint32_t value_size = vs_order[vs_idx];
 
-            for (int vs_idx = 0; vs_idx < value_sizes.size(); vs_idx++) {
-              uint32_t value_size = value_sizes[vs_idx];
+              // Nothing to load if every point using this dataset is done.
+              if (journal.isDone({server_size, key_size, value_size},
+                  {ds_sizes, multi_sizes}))
+                continue;
 
               // Write out dataset.
-              for (int i = 0; i < ds_size_max; i++) {
-                char randomValue[value_size];
-                client.write(tableId, keys[i], key_size, randomValue, value_size);
-              }
+              planner.load(&loader, keySet.getKeys(), key_size, ds_size_max,
+                  arena.getValue(), value_size);
 
               for (int dss_idx = 0; dss_idx < ds_sizes.size(); dss_idx++) {
                 uint32_t ds_size = ds_sizes[dss_idx];
@@ -992,205 +2069,1095 @@ try
                 for (int ms_idx = 0; ms_idx < multi_sizes.size(); ms_idx++) {
                   uint32_t multi_size = multi_sizes[ms_idx];
 
-                  printf("Multiread Fixed DSS Chunked Test: server_size: %d, ds_size: %d, key_size: %dB, value_size: %dB, multi_size: %d\n", server_size, ds_size, key_size, value_size, multi_size);
+                  if (journal.isDone({server_size, key_size, value_size, ds_size, multi_size}))
+                    continue;
+                  trace.beginPoint(filename, {server_size, key_size, value_size, ds_size, multi_size});
+                  metrics.begin();
 
-                  // Prepare multiread data structures.
-                  MultiReadObject requestObjects[multi_size];
-                  MultiReadObject* requests[multi_size];
-                  Tub<ObjectBuffer> values[multi_size];
+                  printf("Multiread Fixed DSS Chunked Test: server_size: %d, ds_size: %d, key_size: %dB, value_size: %dB, multi_size: %d\n", server_size, ds_size, key_size, value_size, multi_size);
 
-                  uint64_t latency[samples_per_point];
-                  for (int i = 0; i < samples_per_point; i++) {
+                  LatencyHistogram latencyHist(histogram_precision);
+                  PointSampler sampler(samplingConfig, &latencyHist);
+                  while (sampler.more()) {
                     uint64_t start = Cycles::rdtsc();
                     uint32_t mark = 0;
                     while (mark < ds_size) {
                       uint32_t batch_size = std::min(multi_size, ds_size - mark);
-                      for (int j = 0; j < batch_size; j++) {
-                        requestObjects[j] = MultiReadObject(tableId, 
-                            keys[mark + j], key_size, &values[j]);
-                        requests[j] = &requestObjects[j];
-                      }
+                      MultiReadObject** requests = arena.prepare(0, tableId,
+                          keySet.getKey(mark), key_size, batch_size);
 
                       client.multiRead(requests, batch_size);
 
                       mark += batch_size;
                     }
                     uint64_t end = Cycles::rdtsc();
-                    latency[i] = Cycles::toNanoseconds(end-start);
-                  }
-
-                  std::vector<uint64_t> latencyVec(latency, latency+samples_per_point);
-
-                  std::sort(latencyVec.begin(), latencyVec.end());
-
-                  uint64_t sum = 0;
-                  for (int i = 0; i < samples_per_point; i++) {
-                    sum += latencyVec[i];
+                    sampler.record(Cycles::toNanoseconds(end-start));
                   }
 
-                  fprintf(datFile, "%12d %12d %12d %12d %12d %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f\n", 
+                  fprintf(datFile, "%12d %12d %12d %12d %12d", 
                       server_size,
                       key_size,
                       value_size,
                       ds_size,
-                      multi_size,
-                      latencyVec[samples_per_point*1/100]/1000.0,
-                      latencyVec[samples_per_point*2/100]/1000.0,
-                      latencyVec[samples_per_point*5/100]/1000.0,
-                      latencyVec[samples_per_point*10/100]/1000.0,
-                      latencyVec[samples_per_point*25/100]/1000.0,
-                      latencyVec[samples_per_point*50/100]/1000.0,
-                      latencyVec[samples_per_point*75/100]/1000.0,
-                      latencyVec[samples_per_point*90/100]/1000.0,
-                      latencyVec[samples_per_point*95/100]/1000.0,
-                      latencyVec[samples_per_point*98/100]/1000.0,
-                      latencyVec[samples_per_point*99/100]/1000.0);
+                      multi_size);
+                  latencyHist.printPercentiles(datFile, 1000.0, 3);
+                  fprintf(datFile, " %12lu %12.4f\n", 
+                      latencyHist.getCount(),
+                      PointSampler::getRelativeCIWidth(latencyHist, samplingConfig));
                   fflush(datFile);
+                  metrics.end({server_size, key_size, value_size, ds_size, multi_size});
+                  journal.markDone({server_size, key_size, value_size, ds_size, multi_size});
                 } // ms_idx
               } // dss_idx
             } // vs_idx
           } // ks_idx
-
-          client.dropTable("test");
         } // sv_idx
 
         fclose(datFile);
-      } else if (op.compare("readop_async") == 0) {
+        planner.printSummary(op.c_str());
+      } else if (op.compare("multiread_fixeddss_chunked_pipelined") == 0) {
         // Open data file for writing.
         FILE * datFile;
         char filename[512];
-        sprintf(filename, "readop_async.spp_%d.sv_%d_%d_%d%s.ks_%d_%d_%d%s.vs_%d_%d_%d%s.ms_%d_%d_%d%s.csv", samples_per_point, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), multi_size_start, multi_size_end, multi_size_points, multi_size_mode.c_str());
-        datFile = fopen(filename, "w");
-        fprintf(datFile, "%12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s %12s\n", 
+        sprintf(filename, "multiread_fixeddss_chunked_pipelined.spp_%d.ss_%d_%d_%d%s.ks_%d_%d_%d%s.vs_%d_%d_%d%s.ds_%d_%d_%d%s.ms_%d_%d_%d%s.pd_%d_%d_%d%s.csv", samples_per_point, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), ds_size_start, ds_size_end, ds_size_points, ds_size_mode.c_str(), multi_size_start, multi_size_end, multi_size_points, multi_size_mode.c_str(), pipeline_depth_start, pipeline_depth_end, pipeline_depth_points, pipeline_depth_mode.c_str());
+        SweepJournal journal(filename, configHash, resume);
+        datFile = journal.openOutput();
+        PointMetrics metrics(&client, server_metrics, &journal,
+            {"ServerSize", "KeySize", "ValueSize", "DatasetSize", "MultiSize", "PipeDepth"});
+        fprintf(datFile, "%12s %12s %12s %12s %12s %12s", 
             "ServerSize",
             "KeySize",
             "ValueSize",
+            "DatasetSize",
             "MultiSize",
-            "1th",
-            "2th",
-            "5th",
-            "10th",
-            "25th",
-            "50th",
-            "75th",
-            "90th",
-            "95th",
-            "98th",
-            "99th");
+            "PipeDepth");
+        LatencyHistogram::printHeader(datFile);
+        fprintf(datFile, " %12s %12s %12s\n", 
+            "GB/s",
+            "Samples",
+            "CIWidth");
+
+        // Start with the server span and value sizes that are already
+        // loaded, if any.
+        std::vector<uint32_t> sv_order = planner.orderServerSizes(server_sizes);
+        for (int sv_idx = 0; sv_idx < sv_order.size(); sv_idx++) {
+          uint32_t server_size = sv_order[sv_idx];
+
+          uint64_t tableId = planner.getTable(server_size);
+          BulkLoader loader(&client, load_batch_size, load_pipeline_depth);
+          // Every slot in the window gets its own multi_size_max requests.
+          RequestArena arena(pipeline_depth_max * multi_size_max,
+              value_size_max);
+          std::vector<Tub<MultiRead>> rpcs(pipeline_depth_max);
 
-        for (int sv_idx = 0; sv_idx < server_sizes.size(); sv_idx++) {
-          uint32_t server_size = server_sizes[sv_idx];
+          for (int ks_idx = 0; ks_idx < key_sizes.size(); ks_idx++) {
+            uint32_t key_size = key_sizes[ks_idx];
 
-          uint64_t tableId = client.createTable("test", server_size);
+            // Construct keys.
+            KeySet keySet(tableId, server_size, key_size, ds_size_max,
+                keyCacheDir);
 
-          // Calculate hash ranges.
-          uint64_t endKeyHashes[server_size];
-          uint64_t tabletRange = 1 + ~0UL / server_size;
-          for (uint32_t i = 0; i < server_size; i++) {
-            uint64_t startKeyHash = i * tabletRange;
-            uint64_t endKeyHash = startKeyHash + tabletRange - 1;
-            if (i == (server_size - 1))
-              endKeyHash = ~0UL;
+            std::vector<uint32_t> vs_order = planner.orderValueSizes(key_size,
+                value_sizes);
+            for (int vs_idx = 0; vs_idx < vs_order.size(); vs_idx++) {
+              uint32_t value_size = vs_order[vs_idx];
 
-            endKeyHashes[i] = endKeyHash;
-          }
+              // Nothing to load if every point using this dataset is done.
+              if (journal.isDone({server_size, key_size, value_size},
+                  {ds_sizes, multi_sizes, pipeline_depths}))
+                continue;
+
+              // Write out dataset.
+              planner.load(&loader, keySet.getKeys(), key_size, ds_size_max,
+                  arena.getValue(), value_size);
+
+              for (int dss_idx = 0; dss_idx < ds_sizes.size(); dss_idx++) {
+                uint32_t ds_size = ds_sizes[dss_idx];
+
+                for (int ms_idx = 0; ms_idx < multi_sizes.size(); ms_idx++) {
+                  uint32_t multi_size = multi_sizes[ms_idx];
+
+                  for (int pd_idx = 0; pd_idx < pipeline_depths.size(); pd_idx++) {
+                    uint32_t pipeline_depth = pipeline_depths[pd_idx];
+
+                    if (journal.isDone({server_size, key_size, value_size, ds_size, multi_size, pipeline_depth}))
+                      continue;
+                    trace.beginPoint(filename, {server_size, key_size, value_size, ds_size, multi_size, pipeline_depth});
+                    metrics.begin();
+
+                    printf("Multiread Fixed DSS Chunked Pipelined Test: server_size: %d, ds_size: %d, key_size: %dB, value_size: %dB, multi_size: %d, pipeline_depth: %d\n", server_size, ds_size, key_size, value_size, multi_size, pipeline_depth);
+
+                    LatencyHistogram latencyHist(histogram_precision);
+                    PointSampler sampler(samplingConfig, &latencyHist);
+                    while (sampler.more()) {
+                      uint64_t start = Cycles::rdtsc();
+                      uint32_t mark = 0;
+                      uint32_t outstanding = 0;
+                      while (mark < ds_size || outstanding > 0) {
+                        for (uint32_t slot = 0; slot < pipeline_depth; slot++) {
+                          if (rpcs[slot]) {
+                            if (!rpcs[slot]->isReady())
+                              continue;
+
+                            rpcs[slot]->wait();
+                            rpcs[slot].destroy();
+                            outstanding--;
+                          }
+
+                          if (mark < ds_size) {
+                            uint32_t batch_size = std::min(multi_size, ds_size - mark);
+                            MultiReadObject** requests = arena.prepare(
+                                slot * multi_size_max, tableId,
+                                keySet.getKey(mark), key_size, batch_size);
+
+                            rpcs[slot].construct(&client, requests, batch_size);
+                            outstanding++;
+                            mark += batch_size;
+                          }
+                        }
+
+                        client.poll();
+                      }
+                      uint64_t end = Cycles::rdtsc();
+                      sampler.record(Cycles::toNanoseconds(end-start));
+                    }
+
+                    double gbPerSec = (double)ds_size * (key_size + value_size) / 
+                        latencyHist.getMean();
+
+                    fprintf(datFile, "%12d %12d %12d %12d %12d %12d", 
+                        server_size,
+                        key_size,
+                        value_size,
+                        ds_size,
+                        multi_size,
+                        pipeline_depth);
+                    latencyHist.printPercentiles(datFile, 1000.0, 3);
+                    fprintf(datFile, " %12.3f %12lu %12.4f\n", 
+                        gbPerSec,
+                        latencyHist.getCount(),
+                        PointSampler::getRelativeCIWidth(latencyHist, samplingConfig));
+                    fflush(datFile);
+                    metrics.end({server_size, key_size, value_size, ds_size, multi_size, pipeline_depth});
+                    journal.markDone({server_size, key_size, value_size, ds_size, multi_size, pipeline_depth});
+                  } // pd_idx
+                } // ms_idx
+              } // dss_idx
+            } // vs_idx
+          } // ks_idx
+        } // sv_idx
+
+        fclose(datFile);
+        planner.printSummary(op.c_str());
+      } else if (op.compare("readop_async") == 0) {
+        // Open data file for writing.
+        FILE * datFile;
+        char filename[512];
+        sprintf(filename, "readop_async.spp_%d.sv_%d_%d_%d%s.ks_%d_%d_%d%s.vs_%d_%d_%d%s.ms_%d_%d_%d%s.pd_%d_%d_%d%s.csv", samples_per_point, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), multi_size_start, multi_size_end, multi_size_points, multi_size_mode.c_str(), pipeline_depth_start, pipeline_depth_end, pipeline_depth_points, pipeline_depth_mode.c_str());
+        SweepJournal journal(filename, configHash, resume);
+        datFile = journal.openOutput();
+        PointMetrics metrics(&client, server_metrics, &journal,
+            {"ServerSize", "KeySize", "ValueSize", "MultiSize", "PipeDepth"});
+        fprintf(datFile, "%12s %12s %12s %12s %12s", 
+            "ServerSize",
+            "KeySize",
+            "ValueSize",
+            "MultiSize",
+            "PipeDepth");
+        LatencyHistogram::printHeader(datFile);
+        LatencyHistogram::printHeader(datFile, "Op");
+        fprintf(datFile, " %12s %12s\n", 
+            "Samples",
+            "CIWidth");
+
+        // Start with the server span and value sizes that are already
+        // loaded, if any.
+        std::vector<uint32_t> sv_order = planner.orderServerSizes(server_sizes);
+        for (int sv_idx = 0; sv_idx < sv_order.size(); sv_idx++) {
+          uint32_t server_size = sv_order[sv_idx];
+
+          uint64_t tableId = planner.getTable(server_size);
+          BulkLoader loader(&client, load_batch_size, load_pipeline_depth);
+          RequestArena arena(0, value_size_max);
+
+          // Sliding window of outstanding ReadOps, each with its own value
+          // buffer and the time it was issued.
+          std::vector<Tub<Transaction::ReadOp>> readOps(pipeline_depth_max);
+          std::vector<Buffer> values(pipeline_depth_max);
+          std::vector<uint64_t> issueTimes(pipeline_depth_max);
 
           for (int ks_idx = 0; ks_idx < key_sizes.size(); ks_idx++) {
             uint32_t key_size = key_sizes[ks_idx];
 
             // Construct keys.
-            char keys[multi_size_max][key_size];
-            memset(keys, 0, multi_size_max * key_size);
-            uint32_t key_candidate = 0;
-            uint32_t n = 0;
-            while (n < multi_size_max) {
-              sprintf(keys[n], "%d", key_candidate);
-
-              // Find the tablet this key belongs to.
-              uint64_t keyHash = Key::getHash(tableId, (const void*)keys[n],
-                  (uint16_t)key_size);
-              uint64_t tablet = 0;
-              for (uint32_t j = 0; j < server_size; j++) {
-                if (keyHash <= endKeyHashes[j]) {
-                  tablet = j;
-                  break;
-                }
-              }
-              
-              if (tablet == n % server_size) {
-                n++;
-              }
+            KeySet keySet(tableId, server_size, key_size, multi_size_max,
+                keyCacheDir);
 
-              key_candidate++;
-            }
+            std::vector<uint32_t> vs_order = planner.orderValueSizes(key_size,
+                value_sizes);
+            for (int vs_idx = 0; vs_idx < vs_order.size(); vs_idx++) {
+              uint32_t value_size = vs_order[vs_idx];
 
-            for (int vs_idx = 0; vs_idx < value_sizes.size(); vs_idx++) {
-              uint32_t value_size = value_sizes[vs_idx];
+              // Nothing to load if every point using this dataset is done.
+              if (journal.isDone({server_size, key_size, value_size},
+                  {multi_sizes, pipeline_depths}))
+                continue;
 
               // Write out dataset.
-              for (int i = 0; i < ds_size_max; i++) {
-                char randomValue[value_size];
-                client.write(tableId, keys[i], key_size, randomValue, value_size);
-              }
+              planner.load(&loader, keySet.getKeys(), key_size, multi_size_max,
+                  arena.getValue(), value_size);
 
               for (int ms_idx = 0; ms_idx < multi_sizes.size(); ms_idx++) {
                 uint32_t multi_size = multi_sizes[ms_idx];
-                printf("Asynchronous ReadOp Test: server_size: %d, key_size: %dB, value_size: %dB, multi_size: %d\n", server_size, key_size, value_size, multi_size);
 
-                int READOP_POOL_SIZE = 100;
-                Tub<Transaction::ReadOp> readOps[READOP_POOL_SIZE];
-                Buffer values[READOP_POOL_SIZE];
+                for (int pd_idx = 0; pd_idx < pipeline_depths.size(); pd_idx++) {
+                  uint32_t pipeline_depth = pipeline_depths[pd_idx];
 
-                uint64_t latency[samples_per_point];
-                for (int i = 0; i < samples_per_point; i++) {
-                  Transaction tx(&client);
+                  if (journal.isDone({server_size, key_size, value_size, multi_size, pipeline_depth}))
+                    continue;
+                  trace.beginPoint(filename, {server_size, key_size, value_size, multi_size, pipeline_depth});
+                  metrics.begin();
 
-                  uint64_t start = Cycles::rdtsc();
-                  for (int j = 0; j < multi_size; j++) {
-                    readOps[j % READOP_POOL_SIZE].construct(&tx, tableId, (const char*)keys[j], key_size, &values[j % READOP_POOL_SIZE], true);
+                  printf("Asynchronous ReadOp Test: server_size: %d, key_size: %dB, value_size: %dB, multi_size: %d, pipeline_depth: %d\n", server_size, key_size, value_size, multi_size, pipeline_depth);
 
-                    if ((j + 1) % READOP_POOL_SIZE == 0) {
-                      for (int k = 0; k < READOP_POOL_SIZE; k++) {
-                        readOps[k]->wait();
+                  LatencyHistogram latencyHist(histogram_precision);
+                  LatencyHistogram opLatencyHist(histogram_precision);
+                  PointSampler sampler(samplingConfig, &latencyHist);
+                  while (sampler.more()) {
+                    Transaction tx(&client);
+
+                    uint64_t start = Cycles::rdtsc();
+                    uint32_t mark = 0;
+                    uint32_t outstanding = 0;
+                    while (mark < multi_size || outstanding > 0) {
+                      for (uint32_t slot = 0; slot < pipeline_depth; slot++) {
+                        if (readOps[slot]) {
+                          if (!readOps[slot]->isReady())
+                            continue;
+
+                          readOps[slot]->wait();
+                          uint64_t end = Cycles::rdtsc();
+                          if (!sampler.warmingUp())
+                            opLatencyHist.record(Cycles::toNanoseconds(end - issueTimes[slot]));
+                          readOps[slot].destroy();
+                          outstanding--;
+                        }
+
+                        if (mark < multi_size) {
+                          // Unbatched, so the read is sent right away.
+                          values[slot].reset();
+                          issueTimes[slot] = Cycles::rdtsc();
+                          readOps[slot].construct(&tx, tableId, keySet.getKey(mark), key_size, &values[slot], false);
+                          outstanding++;
+                          mark++;
+                        }
                       }
+
+                      client.poll();
                     }
+                    uint64_t end = Cycles::rdtsc();
+
+                    sampler.record(Cycles::toNanoseconds(end-start));
                   }
 
-                  for (int j = 0; j < (multi_size % READOP_POOL_SIZE); j++) {
-                    readOps[j]->wait();
+                  fprintf(datFile, "%12d %12d %12d %12d %12d", 
+                      server_size,
+                      key_size,
+                      value_size,
+                      multi_size,
+                      pipeline_depth);
+                  latencyHist.printPercentiles(datFile, 1000.0, 1);
+                  opLatencyHist.printPercentiles(datFile, 1000.0, 1);
+                  fprintf(datFile, " %12lu %12.4f\n", 
+                      latencyHist.getCount(),
+                      PointSampler::getRelativeCIWidth(latencyHist, samplingConfig));
+                  fflush(datFile);
+                  metrics.end({server_size, key_size, value_size, multi_size, pipeline_depth});
+                  journal.markDone({server_size, key_size, value_size, multi_size, pipeline_depth});
+                } // pd_idx
+              } // ms_idx
+            } // vs_idx
+          } // ks_idx
+        } // sv_idx
+
+        fclose(datFile);
+        planner.printSummary(op.c_str());
+      } else if (op.compare("scan") == 0) {
+        // Open data file for writing.
+        FILE * datFile;
+        char filename[512];
+        sprintf(filename, "scan.spp_%d.ss_%d_%d_%d%s.ks_%d_%d_%d%s.vs_%d_%d_%d%s.ds_%d_%d_%d%s.csv", samples_per_point, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), ds_size_start, ds_size_end, ds_size_points, ds_size_mode.c_str());
+        SweepJournal journal(filename, configHash, resume);
+        datFile = journal.openOutput();
+        PointMetrics metrics(&client, server_metrics, &journal,
+            {"ServerSize", "KeySize", "ValueSize", "DatasetSize"});
+        fprintf(datFile, "%12s %12s %12s %12s %12s", 
+            "ServerSize",
+            "KeySize",
+            "ValueSize",
+            "DatasetSize",
+            "Enumerators");
+        LatencyHistogram::printHeader(datFile);
+        fprintf(datFile, " %12s %12s %12s %12s %12s\n", 
+            "FirstObj",
+            "Objs/s",
+            "Bytes/s",
+            "Samples",
+            "CIWidth");
+
+        RequestArena arena(0, value_size_max);
+
+        for (int sv_idx = 0; sv_idx < server_sizes.size(); sv_idx++) {
+          uint32_t server_size = server_sizes[sv_idx];
+          uint64_t tabletRange = 1 + ~0UL / server_size;
+
+          for (int ks_idx = 0; ks_idx < key_sizes.size(); ks_idx++) {
+            uint32_t key_size = key_sizes[ks_idx];
+
+            for (int vs_idx = 0; vs_idx < value_sizes.size(); vs_idx++) {
+              uint32_t value_size = value_sizes[vs_idx];
+
+              // Nothing to load if every point using this dataset is done.
+              if (journal.isDone({server_size, key_size, value_size},
+                  {ds_sizes}))
+                continue;
+
+              // Scans read the whole table, so every key and value size
+              // combination needs a table of its own.
+              uint64_t tableId = client.createTable("test", server_size);
+              BulkLoader loader(&client, load_batch_size, load_pipeline_depth);
+
+              // Construct keys.
+              KeySet keySet(tableId, server_size, key_size, ds_size_max,
+                  keyCacheDir);
+              uint32_t loaded = 0;
+
+              for (int dss_idx = 0; dss_idx < ds_sizes.size(); dss_idx++) {
+                uint32_t ds_size = ds_sizes[dss_idx];
+
+                // Grow the table to ds_size objects.
+                if (ds_size > loaded) {
+                  loader.load(tableId, keySet.getKey(loaded), key_size,
+                      ds_size - loaded, arena.getValue(), value_size);
+                  loaded = ds_size;
+                }
+
+                if (journal.isDone({server_size, key_size, value_size, ds_size}))
+                  continue;
+                trace.beginPoint(filename, {server_size, key_size, value_size, ds_size});
+                metrics.begin();
+
+                printf("Scan Test: server_size: %d, key_size: %dB, value_size: %dB, ds_size: %d\n", server_size, key_size, value_size, ds_size);
+
+                // Single enumerator over the whole table.
+                LatencyHistogram latencyHist(histogram_precision);
+                LatencyHistogram firstObjectHist(histogram_precision);
+                PointSampler sampler(samplingConfig, &latencyHist);
+                while (sampler.more()) {
+                  uint32_t count = 0;
+                  uint64_t start = Cycles::rdtsc();
+                  TableEnumerator iter(client, tableId, false);
+                  while (iter.hasNext()) {
+                    uint32_t size;
+                    const void* object;
+                    iter.next(&size, &object);
+                    if (count == 0 && !sampler.warmingUp())
+                      firstObjectHist.record(Cycles::toNanoseconds(Cycles::rdtsc() - start));
+                    count++;
                   }
                   uint64_t end = Cycles::rdtsc();
+                  sampler.record(Cycles::toNanoseconds(end-start));
 
-                  latency[i] = Cycles::toNanoseconds(end-start);
+                  if (count != loaded)
+                    printf("WARNING: Scan returned %d objects, expected %d\n", count, loaded);
                 }
 
-                std::vector<uint64_t> latencyVec(latency, latency+samples_per_point);
+                double objsPerSec = ds_size / (latencyHist.getMean() / 1e9);
 
-                std::sort(latencyVec.begin(), latencyVec.end());
+                fprintf(datFile, "%12d %12d %12d %12d %12d", 
+                    server_size,
+                    key_size,
+                    value_size,
+                    ds_size,
+                    1);
+                latencyHist.printPercentiles(datFile, 1000.0, 1);
+                fprintf(datFile, " %12.1f %12.0f %12.4g %12lu %12.4f\n", 
+                    firstObjectHist.getPercentile(50) / 1000.0,
+                    objsPerSec,
+                    objsPerSec * (key_size + value_size),
+                    latencyHist.getCount(),
+                    PointSampler::getRelativeCIWidth(latencyHist, samplingConfig));
+                fflush(datFile);
 
-                uint64_t sum = 0;
-                for (int i = 0; i < samples_per_point; i++) {
-                  sum += latencyVec[i];
+                // One enumerator per tablet, in parallel.
+                latencyHist.reset();
+                firstObjectHist.reset();
+                PointSampler parallelSampler(samplingConfig, &latencyHist);
+                while (parallelSampler.more()) {
+                  std::vector<uint32_t> counts(server_size);
+                  std::vector<uint64_t> firstObjectTimes(server_size);
+                  ClientThreads clientThreads(&client, &optionParser.options,
+                      server_size);
+                  clientThreads.run([&](RamCloud* threadClient, uint32_t threadIndex) {
+                    uint64_t tabletFirstHash = threadIndex * tabletRange;
+                    Buffer state;
+                    Buffer objects;
+                    uint32_t count = 0;
+                    uint64_t firstObjectTime = 0;
+
+                    // Each sample's threads get new clients. Fetch the
+                    // tablet map and open a session to the tablet's master
+                    // untimed, as the single enumerator's client already
+                    // has.
+                    {
+                      Buffer warmState;
+                      EnumerateTableRpc warm(threadClient, tableId, false,
+                          tabletFirstHash, warmState, objects);
+                      warm.wait(warmState);
+                    }
+
+                    clientThreads.start();
+                    uint64_t start = Cycles::rdtsc();
+                    while (true) {
+                      objects.reset();
+                      EnumerateTableRpc rpc(threadClient, tableId, false,
+                          tabletFirstHash, state, objects);
+                      uint64_t nextHash = rpc.wait(state);
+
+                      // Objects are returned as a 32-bit length followed by
+                      // the object itself.
+                      uint32_t offset = 0;
+                      while (offset < objects.size()) {
+                        uint32_t size = *objects.getOffset<uint32_t>(offset);
+                        offset += (uint32_t)sizeof(uint32_t) + size;
+                        count++;
+                      }
+                      if (count > 0 && firstObjectTime == 0)
+                        firstObjectTime = Cycles::rdtsc() - start;
+
+                      // The server keeps returning this tablet's first hash
+                      // until the tablet is exhausted, then moves on to the
+                      // next tablet (or 0 after the last one).
+                      if (nextHash != tabletFirstHash || objects.size() == 0)
+                        break;
+                    }
+                    clientThreads.stop();
+
+                    counts[threadIndex] = count;
+                    firstObjectTimes[threadIndex] = firstObjectTime;
+                  });
+
+                  bool measured = parallelSampler.record(
+                      clientThreads.getElapsedSeconds() * 1e9, 1);
+
+                  uint32_t count = 0;
+                  uint64_t firstObjectTime = ~0UL;
+                  for (int t = 0; t < server_size; t++) {
+                    count += counts[t];
+                    if (counts[t] > 0 && firstObjectTimes[t] < firstObjectTime)
+                      firstObjectTime = firstObjectTimes[t];
+                  }
+                  if (measured && count > 0)
+                    firstObjectHist.record(Cycles::toNanoseconds(firstObjectTime));
+
+                  if (count != loaded)
+                    printf("WARNING: Parallel scan returned %d objects, expected %d\n", count, loaded);
                 }
 
-                fprintf(datFile, "%12d %12d %12d %12d %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n",
+                objsPerSec = ds_size / (latencyHist.getMean() / 1e9);
+
+                fprintf(datFile, "%12d %12d %12d %12d %12d", 
                     server_size,
                     key_size,
                     value_size,
-                    multi_size,
-                    latencyVec[samples_per_point*1/100]/1000.0,
-                    latencyVec[samples_per_point*2/100]/1000.0,
-                    latencyVec[samples_per_point*5/100]/1000.0,
-                    latencyVec[samples_per_point*10/100]/1000.0,
-                    latencyVec[samples_per_point*25/100]/1000.0,
-                    latencyVec[samples_per_point*50/100]/1000.0,
-                    latencyVec[samples_per_point*75/100]/1000.0,
-                    latencyVec[samples_per_point*90/100]/1000.0,
-                    latencyVec[samples_per_point*95/100]/1000.0,
-                    latencyVec[samples_per_point*98/100]/1000.0,
-                    latencyVec[samples_per_point*99/100]/1000.0);
+                    ds_size,
+                    server_size);
+                latencyHist.printPercentiles(datFile, 1000.0, 1);
+                fprintf(datFile, " %12.1f %12.0f %12.4g %12lu %12.4f\n", 
+                    firstObjectHist.getPercentile(50) / 1000.0,
+                    objsPerSec,
+                    objsPerSec * (key_size + value_size),
+                    latencyHist.getCount(),
+                    PointSampler::getRelativeCIWidth(latencyHist, samplingConfig));
                 fflush(datFile);
-              } // ms_idx
+                metrics.end({server_size, key_size, value_size, ds_size});
+                journal.markDone({server_size, key_size, value_size, ds_size});
+              } // dss_idx
+
+              client.dropTable("test");
+            } // vs_idx
+          } // ks_idx
+        } // sv_idx
+
+        fclose(datFile);
+      } else if (op.compare("index_lookup") == 0) {
+        // Open data files for writing.
+        FILE * datFile;
+        FILE * insertFile;
+        char filename[512];
+        sprintf(filename, "index_lookup.spp_%d.ni_%d.ss_%d_%d_%d%s.il_%d_%d_%d%s.ks_%d_%d_%d%s.vs_%d_%d_%d%s.ds_%d_%d_%d%s.ms_%d_%d_%d%s.csv", samples_per_point, num_indexes, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), indexlets_start, indexlets_end, indexlets_points, indexlets_mode.c_str(), key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), ds_size_start, ds_size_end, ds_size_points, ds_size_mode.c_str(), multi_size_start, multi_size_end, multi_size_points, multi_size_mode.c_str());
+        SweepJournal journal(filename, configHash, resume);
+        datFile = journal.openOutput();
+        PointMetrics metrics(&client, server_metrics, &journal,
+            {"ServerSize", "Indexlets", "KeySize", "ValueSize", "DatasetSize", "RangeSize"});
+        fprintf(datFile, "%12s %12s %12s %12s %12s %12s", 
+            "ServerSize",
+            "Indexlets",
+            "KeySize",
+            "ValueSize",
+            "DatasetSize",
+            "RangeSize");
+        LatencyHistogram::printHeader(datFile);
+        fprintf(datFile, " %12s %12s %12s\n", 
+            "Objs/s",
+            "Samples",
+            "CIWidth");
+
+        char insertFilename[512];
+        sprintf(insertFilename, "index_insert.ni_%d.ss_%d_%d_%d%s.il_%d_%d_%d%s.ks_%d_%d_%d%s.vs_%d_%d_%d%s.ds_%d_%d_%d%s.csv", num_indexes, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), indexlets_start, indexlets_end, indexlets_points, indexlets_mode.c_str(), key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), ds_size_start, ds_size_end, ds_size_points, ds_size_mode.c_str());
+        SweepJournal insertJournal(insertFilename, configHash, resume);
+        insertFile = insertJournal.openOutput();
+        fprintf(insertFile, "%12s %12s %12s %12s %12s", 
+            "ServerSize",
+            "Indexlets",
+            "KeySize",
+            "ValueSize",
+            "DatasetSize");
+        LatencyHistogram::printHeader(insertFile);
+        fprintf(insertFile, " %12s %12s\n", 
+            "NoIndex50th",
+            "Slowdown50th");
+
+        RequestArena arena(0, value_size_max);
+
+        for (int sv_idx = 0; sv_idx < server_sizes.size(); sv_idx++) {
+          uint32_t server_size = server_sizes[sv_idx];
+
+          for (int il_idx = 0; il_idx < indexlet_counts.size(); il_idx++) {
+            uint32_t indexlets = indexlet_counts[il_idx];
+
+            for (int ks_idx = 0; ks_idx < key_sizes.size(); ks_idx++) {
+              uint32_t key_size = key_sizes[ks_idx];
+
+              for (int vs_idx = 0; vs_idx < value_sizes.size(); vs_idx++) {
+                uint32_t value_size = value_sizes[vs_idx];
+
+                for (int dss_idx = 0; dss_idx < ds_sizes.size(); dss_idx++) {
+                  uint32_t ds_size = ds_sizes[dss_idx];
+
+                  // Secondary keys are zero padded object numbers, so they
+                  // must have room for every digit.
+                  char digits[16];
+                  if (sprintf(digits, "%u", ds_size - 1) > key_size) {
+                    printf("WARNING: Unsatisfiable parameter values (ds_size=%d, key_size=%d). Keys too small to hold distinct secondary keys. Skipping this parameter configuration.\n", ds_size, key_size);
+                    continue;
+                  }
+
+                  // The inserts also build the dataset for the lookups, so
+                  // they are only skipped along with all of the lookups.
+                  bool insertDone = insertJournal.isDone({server_size,
+                      indexlets, key_size, value_size, ds_size});
+                  if (insertDone && journal.isDone({server_size, indexlets,
+                      key_size, value_size, ds_size}, {multi_sizes}))
+                    continue;
+
+                  printf("Index Lookup Test: server_size: %d, indexlets: %d, key_size: %dB, value_size: %dB, ds_size: %d\n", server_size, indexlets, key_size, value_size, ds_size);
+
+                  // Insert every object with its primary key and num_indexes
+                  // identical secondary keys, recording insert latency.
+                  std::vector<char> secondaryKey(key_size + 1);
+                  std::vector<KeyInfo> keyList(1 + num_indexes);
+                  auto insertAll = [&](uint64_t tableId, const KeySet& keySet,
+                      LatencyHistogram* hist) {
+                    for (uint32_t n = 0; n < ds_size; n++) {
+                      sprintf(&secondaryKey[0], "%0*u", key_size, n);
+                      keyList[0].key = keySet.getKey(n);
+                      keyList[0].keyLength = key_size;
+                      for (int j = 1; j <= num_indexes; j++) {
+                        keyList[j].key = &secondaryKey[0];
+                        keyList[j].keyLength = key_size;
+                      }
+
+                      uint64_t start = Cycles::rdtsc();
+                      client.write(tableId, 1 + num_indexes, &keyList[0],
+                          arena.getValue(), value_size);
+                      uint64_t end = Cycles::rdtsc();
+                      hist->record(Cycles::toNanoseconds(end-start));
+                    }
+                  };
+
+                  // Baseline: the same objects in a table without indexes.
+                  // Both tables are recreated for every point, with new
+                  // table ids, so their key sets are never cached.
+                  LatencyHistogram noIndexHist(histogram_precision);
+                  {
+                    uint64_t tableId = client.createTable("test", server_size);
+                    KeySet keySet(tableId, server_size, key_size, ds_size);
+                    insertAll(tableId, keySet, &noIndexHist);
+                    client.dropTable("test");
+                  }
+
+                  uint64_t tableId = client.createTable("test", server_size);
+                  for (int j = 1; j <= num_indexes; j++)
+                    client.createIndex(tableId, j, 0, indexlets);
+                  KeySet keySet(tableId, server_size, key_size, ds_size);
+
+                  LatencyHistogram insertHist(histogram_precision);
+                  insertAll(tableId, keySet, &insertHist);
+
+                  if (!insertDone) {
+                    fprintf(insertFile, "%12d %12d %12d %12d %12d", 
+                        server_size,
+                        indexlets,
+                        key_size,
+                        value_size,
+                        ds_size);
+                    insertHist.printPercentiles(insertFile, 1000.0, 1);
+                    fprintf(insertFile, " %12.1f %12.2f\n", 
+                        noIndexHist.getPercentile(50) / 1000.0,
+                        (double)insertHist.getPercentile(50) / 
+                        (double)noIndexHist.getPercentile(50));
+                    fflush(insertFile);
+                    insertJournal.markDone({server_size, indexlets, key_size,
+                        value_size, ds_size});
+                  }
+
+                  for (int ms_idx = 0; ms_idx < multi_sizes.size(); ms_idx++) {
+                    uint32_t multi_size = multi_sizes[ms_idx];
+
+                    if (multi_size > ds_size) {
+                      printf("WARNING: Unsatisfiable parameter values (ds_size=%d, multi_size=%d). Range larger than dataset. Skipping this parameter configuration.\n", ds_size, multi_size);
+                      journal.markDone({server_size, indexlets, key_size,
+                          value_size, ds_size, multi_size});
+                      continue;
+                    }
+
+                    if (journal.isDone({server_size, indexlets, key_size, value_size, ds_size, multi_size}))
+                      continue;
+                    trace.beginPoint(filename, {server_size, indexlets, key_size, value_size, ds_size, multi_size});
+                    metrics.begin();
+
+                    printf("Index Lookup Test: server_size: %d, indexlets: %d, key_size: %dB, value_size: %dB, ds_size: %d, multi_size: %d\n", server_size, indexlets, key_size, value_size, ds_size, multi_size);
+
+                    // Ranges start at uniformly chosen objects, the same
+                    // sequence of them for every point.
+                    std::mt19937 generator(0);
+                    std::uniform_int_distribution<uint32_t> firstObject(0,
+                        ds_size - multi_size);
+                    std::vector<char> firstKey(key_size + 1);
+                    std::vector<char> lastKey(key_size + 1);
+
+                    LatencyHistogram latencyHist(histogram_precision);
+                    PointSampler sampler(samplingConfig, &latencyHist);
+                    while (sampler.more()) {
+                      uint32_t first = firstObject(generator);
+                      sprintf(&firstKey[0], "%0*u", key_size, first);
+                      sprintf(&lastKey[0], "%0*u", key_size,
+                          first + multi_size - 1);
+
+                      uint32_t count = 0;
+                      uint64_t start = Cycles::rdtsc();
+                      IndexLookup lookup(&client, tableId, 1, &firstKey[0],
+                          key_size, &lastKey[0], key_size, multi_size);
+                      while (lookup.getNext())
+                        count++;
+                      uint64_t end = Cycles::rdtsc();
+                      sampler.record(Cycles::toNanoseconds(end-start));
+
+                      if (count != multi_size)
+                        printf("WARNING: Index lookup returned %d objects, expected %d\n", count, multi_size);
+                    }
+
+                    fprintf(datFile, "%12d %12d %12d %12d %12d %12d", 
+                        server_size,
+                        indexlets,
+                        key_size,
+                        value_size,
+                        ds_size,
+                        multi_size);
+                    latencyHist.printPercentiles(datFile, 1000.0, 1);
+                    fprintf(datFile, " %12.0f %12lu %12.4f\n", 
+                        multi_size / (latencyHist.getMean() / 1e9),
+                        latencyHist.getCount(),
+                        PointSampler::getRelativeCIWidth(latencyHist, samplingConfig));
+                    fflush(datFile);
+                    metrics.end({server_size, indexlets, key_size, value_size, ds_size, multi_size});
+                    journal.markDone({server_size, indexlets, key_size, value_size, ds_size, multi_size});
+                  } // ms_idx
+
+                  for (int j = 1; j <= num_indexes; j++)
+                    client.dropIndex(tableId, j);
+                  client.dropTable("test");
+                } // dss_idx
+              } // vs_idx
+            } // ks_idx
+          } // il_idx
+        } // sv_idx
+
+        fclose(datFile);
+        fclose(insertFile);
+      } else if (op.compare("transaction") == 0) {
+        // Open data file for writing.
+        FILE * datFile;
+        char filename[512];
+        sprintf(filename, "transaction.spp_%d.rf_%d.hk_%d.ss_%d_%d_%d%s.vs_%d_%d_%d%s.rs_%d_%d_%d%s.ws_%d_%d_%d%s.th_%d_%d_%d%s.csv", samples_per_point, replicas, hot_key_count, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), read_set_size_start, read_set_size_end, read_set_size_points, read_set_size_mode.c_str(), write_set_size_start, write_set_size_end, write_set_size_points, write_set_size_mode.c_str(), threads_start, threads_end, threads_points, threads_mode.c_str());
+        SweepJournal journal(filename, configHash, resume);
+        datFile = journal.openOutput();
+        PointMetrics metrics(&client, server_metrics, &journal,
+            {"ServerSize", "ValueSize", "ReadSet", "WriteSet", "Threads"});
+        fprintf(datFile, "%12s %12s %12s %12s %12s", 
+            "ServerSize",
+            "ValueSize",
+            "ReadSet",
+            "WriteSet",
+            "Threads");
+        LatencyHistogram::printHeader(datFile);
+        fprintf(datFile, " %12s %12s %12s %12s\n", 
+            "Commits/s",
+            "AbortRate",
+            "Samples",
+            "CIWidth");
+
+        uint32_t key_size = 30; // Use fixed 30B keys.
+        uint32_t set_size_max = read_set_size_max + write_set_size_max;
+
+        // Either each thread gets its own set_size_max keys, or all threads
+        // share the first hot_key_count keys.
+        uint32_t key_count = std::max(threads_max * set_size_max,
+            hot_key_count);
+
+        RequestArena arena(0, value_size_max);
+
+        for (int sv_idx = 0; sv_idx < server_sizes.size(); sv_idx++) {
+          uint32_t server_size = server_sizes[sv_idx];
+
+          uint64_t tableId = client.createTable("test", server_size);
+          BulkLoader loader(&client, load_batch_size, load_pipeline_depth);
+
+          // Construct keys.
+          KeySet keySet(tableId, server_size, key_size, key_count,
+              keyCacheDir);
+
+          for (int vs_idx = 0; vs_idx < value_sizes.size(); vs_idx++) {
+            uint32_t value_size = value_sizes[vs_idx];
+
+            // Write out dataset.
+            loader.load(tableId, keySet.getKeys(), key_size, key_count,
+                arena.getValue(), value_size);
+
+            for (int rs_idx = 0; rs_idx < read_set_sizes.size(); rs_idx++) {
+              uint32_t read_set_size = read_set_sizes[rs_idx];
+
+              for (int ws_idx = 0; ws_idx < write_set_sizes.size(); ws_idx++) {
+                uint32_t write_set_size = write_set_sizes[ws_idx];
+                uint32_t set_size = read_set_size + write_set_size;
+
+                if (hot_key_count > 0 && set_size > hot_key_count) {
+                  printf("WARNING: Unsatisfiable parameter values (read_set_size=%d, write_set_size=%d). Not enough hot keys: (read_set_size + write_set_size) > hot_key_count=%d. Skipping this parameter configuration.\n", read_set_size, write_set_size, hot_key_count);
+                  continue;
+                }
+
+                for (int th_idx = 0; th_idx < thread_counts.size(); th_idx++) {
+                  uint32_t thread_count = thread_counts[th_idx];
+
+                  if (journal.isDone({server_size, value_size, read_set_size, write_set_size, thread_count}))
+                    continue;
+                  trace.beginPoint(filename, {server_size, value_size, read_set_size, write_set_size, thread_count});
+                  metrics.begin();
+
+                  printf("Transaction Test: server_size: %d, value_size: %dB, read_set_size: %d, write_set_size: %d, threads: %d, hot_key_count: %d\n", server_size, value_size, read_set_size, write_set_size, thread_count, hot_key_count);
+
+                  std::vector<LatencyHistogram> threadHists(thread_count,
+                      LatencyHistogram(histogram_precision));
+                  std::vector<uint64_t> threadCommits(thread_count);
+                  ClientThreads clientThreads(&client, &optionParser.options,
+                      thread_count);
+                  clientThreads.run([&](RamCloud* threadClient, uint32_t threadIndex) {
+                    // Indexes into keySet of this thread's read set followed
+                    // by its write set.
+                    std::vector<uint32_t> setKeys(set_size);
+                    for (uint32_t k = 0; k < set_size; k++)
+                      setKeys[k] = threadIndex * set_size_max + k;
+
+                    std::mt19937 generator(threadIndex);
+                    Buffer value;
+                    uint64_t commits = 0;
+
+                    LatencyHistogram threadHist(histogram_precision);
+                    PointSampler sampler(samplingConfig, &threadHist,
+                        [&]() { clientThreads.start(); });
+                    while (sampler.more()) {
+                      if (hot_key_count > 0) {
+                        // Pick set_size distinct hot keys.
+                        for (uint32_t k = 0; k < set_size; k++) {
+                          bool duplicate;
+                          do {
+                            setKeys[k] = generator() % hot_key_count;
+                            duplicate = false;
+                            for (uint32_t m = 0; m < k; m++)
+                              duplicate |= (setKeys[m] == setKeys[k]);
+                          } while (duplicate);
+                        }
+                      }
+
+                      Transaction tx(threadClient);
+                      for (uint32_t k = 0; k < read_set_size; k++) {
+                        tx.read(tableId, keySet.getKey(setKeys[k]), key_size,
+                            &value);
+                      }
+                      for (uint32_t k = read_set_size; k < set_size; k++) {
+                        tx.write(tableId, keySet.getKey(setKeys[k]), key_size,
+                            arena.getValue(), value_size);
+                      }
+
+                      uint64_t start = Cycles::rdtsc();
+                      bool committed = tx.commit();
+                      uint64_t end = Cycles::rdtsc();
+                      bool measured = sampler.record(Cycles::toNanoseconds(end-start));
+                      if (measured && committed)
+                        commits++;
+                    }
+                    clientThreads.stop();
+
+                    // Recorded locally so threads never share cache lines while measuring.
+                    threadHists[threadIndex] = threadHist;
+                    threadCommits[threadIndex] = commits;
+                  });
+
+                  LatencyHistogram latencyHist(histogram_precision);
+                  uint64_t commits = 0;
+                  for (int t = 0; t < thread_count; t++) {
+                    latencyHist.merge(threadHists[t]);
+                    commits += threadCommits[t];
+                  }
+
+                  uint64_t attempts = latencyHist.getCount();
+                  double commitsPerSec = (double)commits / clientThreads.getElapsedSeconds();
+
+                  fprintf(datFile, "%12d %12d %12d %12d %12d", 
+                      server_size,
+                      value_size,
+                      read_set_size,
+                      write_set_size,
+                      thread_count);
+                  latencyHist.printPercentiles(datFile, 1000.0, 1);
+                  fprintf(datFile, " %12.0f %12.4f %12lu %12.4f\n", 
+                      commitsPerSec,
+                      (double)(attempts - commits) / (double)attempts,
+                      latencyHist.getCount(),
+                      PointSampler::getRelativeCIWidth(latencyHist, samplingConfig));
+                  fflush(datFile);
+                  metrics.end({server_size, value_size, read_set_size, write_set_size, thread_count});
+                  journal.markDone({server_size, value_size, read_set_size, write_set_size, thread_count});
+                } // th_idx
+              } // ws_idx
+            } // rs_idx
+          } // vs_idx
+
+          client.dropTable("test");
+        } // sv_idx
+
+        fclose(datFile);
+      } else if (op.compare("ycsb") == 0) {
+        YcsbWorkload::Config config;
+        YcsbWorkload::getPreset(workload, &config);
+        if (read_proportion >= 0)
+          config.proportions[YcsbWorkload::READ] = read_proportion;
+        if (update_proportion >= 0)
+          config.proportions[YcsbWorkload::UPDATE] = update_proportion;
+        if (insert_proportion >= 0)
+          config.proportions[YcsbWorkload::INSERT] = insert_proportion;
+        if (scan_proportion >= 0)
+          config.proportions[YcsbWorkload::SCAN] = scan_proportion;
+        if (rmw_proportion >= 0)
+          config.proportions[YcsbWorkload::READ_MODIFY_WRITE] = rmw_proportion;
+        if (request_distribution.size() > 0)
+          YcsbWorkload::parseDistribution(request_distribution, &config.distribution);
+        config.zipfianTheta = zipfian_theta;
+        config.hotDataFraction = hotspot_data_fraction;
+        config.hotOpFraction = hotspot_op_fraction;
+        config.maxScanLength = max_scan_length;
+
+        // Open data file for writing.
+        FILE * datFile;
+        char filename[512];
+        sprintf(filename, "ycsb.spp_%d.rf_%d.wl_%s.rc_%d.ss_%d_%d_%d%s.ks_%d_%d_%d%s.vs_%d_%d_%d%s.th_%d_%d_%d%s.csv", samples_per_point, replicas, workload.c_str(), record_count, server_size_start, server_size_end, server_size_points, server_size_mode.c_str(), key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), threads_start, threads_end, threads_points, threads_mode.c_str());
+        SweepJournal journal(filename, configHash, resume);
+        datFile = journal.openOutput();
+        PointMetrics metrics(&client, server_metrics, &journal,
+            {"ServerSize", "KeySize", "ValueSize", "Threads"});
+        fprintf(datFile, "%12s %12s %12s %12s %12s", 
+            "ServerSize",
+            "KeySize",
+            "ValueSize",
+            "Threads",
+            "Operation");
+        LatencyHistogram::printHeader(datFile);
+        fprintf(datFile, " %12s %12s %12s\n", 
+            "Ops/s",
+            "Samples",
+            "CIWidth");
+
+        // Leave room for every operation to be an insert.
+        uint32_t insert_capacity = 0;
+        if (config.proportions[YcsbWorkload::INSERT] > 0)
+          insert_capacity = (warmup_samples + samples_per_point) * threads_max;
+        uint32_t key_count = record_count + insert_capacity;
+
+        RequestArena arena(threads_max * max_scan_length, value_size_max);
+
+        for (int sv_idx = 0; sv_idx < server_sizes.size(); sv_idx++) {
+          uint32_t server_size = server_sizes[sv_idx];
+
+          uint64_t tableId = client.createTable("test", server_size);
+          BulkLoader loader(&client, load_batch_size, load_pipeline_depth);
+
+          for (int ks_idx = 0; ks_idx < key_sizes.size(); ks_idx++) {
+            uint32_t key_size = key_sizes[ks_idx];
+
+            // Construct keys. Record n has key n.
+            KeySet keySet(tableId, server_size, key_size, key_count,
+                keyCacheDir);
+
+            for (int vs_idx = 0; vs_idx < value_sizes.size(); vs_idx++) {
+              uint32_t value_size = value_sizes[vs_idx];
+
+              // Nothing to load if every point using this dataset is done.
+              if (journal.isDone({server_size, key_size, value_size},
+                  {thread_counts}))
+                continue;
+
+              // Write out the records.
+              loader.load(tableId, keySet.getKeys(), key_size, record_count,
+                  arena.getValue(), value_size);
+
+              for (int th_idx = 0; th_idx < thread_counts.size(); th_idx++) {
+                uint32_t thread_count = thread_counts[th_idx];
+
+                // Every point starts from the loaded records; records
+                // inserted by earlier points are overwritten as needed.
+                YcsbRecordCount recordCount(record_count);
+
+                if (journal.isDone({server_size, key_size, value_size, thread_count}))
+                  continue;
+                trace.beginPoint(filename, {server_size, key_size, value_size, thread_count});
+                metrics.begin();
+
+                printf("YCSB Test: workload: %s, server_size: %d, key_size: %dB, value_size: %dB, threads: %d\n", workload.c_str(), server_size, key_size, value_size, thread_count);
+
+                std::vector<LatencyHistogram> threadHists(
+                    thread_count * YcsbWorkload::NUM_OPERATIONS,
+                    LatencyHistogram(histogram_precision));
+                ClientThreads clientThreads(&client, &optionParser.options,
+                    thread_count);
+                clientThreads.run([&](RamCloud* threadClient, uint32_t threadIndex) {
+                  YcsbWorkload ycsb(config, &recordCount, threadIndex);
+                  std::vector<LatencyHistogram> opHists(
+                      YcsbWorkload::NUM_OPERATIONS,
+                      LatencyHistogram(histogram_precision));
+                  Buffer value;
+
+                  // Untimed, so that fetching the tablet map and opening
+                  // sessions to the masters isn't part of any operation's
+                  // samples. Record n lives on tablet n % server_size.
+                  for (uint32_t record = 0;
+                      record < std::min(server_size, record_count); record++)
+                    threadClient->read(tableId, keySet.getKey(record), key_size, &value);
+
+                  LatencyHistogram threadHist(histogram_precision);
+                  PointSampler sampler(samplingConfig, &threadHist,
+                      [&]() { clientThreads.start(); });
+                  while (sampler.more()) {
+                    YcsbWorkload::Operation operation = ycsb.nextOperation();
+                    bool exists;
+
+                    uint64_t start = Cycles::rdtsc();
+                    switch (operation) {
+                      case YcsbWorkload::READ: {
+                        uint32_t record = ycsb.nextRecord();
+                        threadClient->read(tableId, keySet.getKey(record), key_size, &value, NULL, NULL, &exists);
+                        break;
+                      }
+                      case YcsbWorkload::UPDATE: {
+                        uint32_t record = ycsb.nextRecord();
+                        threadClient->write(tableId, keySet.getKey(record), key_size, arena.getValue(), value_size);
+                        break;
+                      }
+                      case YcsbWorkload::INSERT: {
+                        uint32_t record = ycsb.insert();
+                        threadClient->write(tableId, keySet.getKey(record), key_size, arena.getValue(), value_size);
+                        ycsb.inserted(record);
+                        break;
+                      }
+                      case YcsbWorkload::SCAN: {
+                        uint32_t record = ycsb.nextRecord();
+                        uint32_t count = std::min(ycsb.nextScanLength(),
+                            recordCount.get() - record);
+                        MultiReadObject** requests = arena.prepare(
+                            threadIndex * max_scan_length, tableId,
+                            keySet.getKey(record), key_size, count);
+                        threadClient->multiRead(requests, count);
+                        break;
+                      }
+                      case YcsbWorkload::READ_MODIFY_WRITE:
+                      default: {
+                        uint32_t record = ycsb.nextRecord();
+                        threadClient->read(tableId, keySet.getKey(record), key_size, &value, NULL, NULL, &exists);
+                        threadClient->write(tableId, keySet.getKey(record), key_size, arena.getValue(), value_size);
+                        break;
+                      }
+                    }
+                    uint64_t end = Cycles::rdtsc();
+                    uint64_t latency = Cycles::toNanoseconds(end-start);
+                    if (sampler.record(latency, operation))
+                      opHists[operation].record(latency);
+                  }
+                  clientThreads.stop();
+
+                  // Recorded locally so threads never share cache lines while measuring.
+                  for (int o = 0; o < YcsbWorkload::NUM_OPERATIONS; o++)
+                    threadHists[threadIndex * YcsbWorkload::NUM_OPERATIONS + o] = opHists[o];
+                });
+
+                double elapsed = clientThreads.getElapsedSeconds();
+                LatencyHistogram totalHist(histogram_precision);
+                for (int o = 0; o < YcsbWorkload::NUM_OPERATIONS; o++) {
+                  LatencyHistogram latencyHist(histogram_precision);
+                  for (int t = 0; t < thread_count; t++)
+                    latencyHist.merge(threadHists[t * YcsbWorkload::NUM_OPERATIONS + o]);
+                  totalHist.merge(latencyHist);
+
+                  if (latencyHist.getCount() == 0)
+                    continue;
+
+                  fprintf(datFile, "%12d %12d %12d %12d %12s", 
+                      server_size,
+                      key_size,
+                      value_size,
+                      thread_count,
+                      YcsbWorkload::operationName(static_cast<YcsbWorkload::Operation>(o)));
+                  latencyHist.printPercentiles(datFile, 1000.0, 1);
+                  fprintf(datFile, " %12.0f %12lu %12.4f\n", 
+                      latencyHist.getCount() / elapsed,
+                      latencyHist.getCount(),
+                      PointSampler::getRelativeCIWidth(latencyHist, samplingConfig));
+                }
+
+                fprintf(datFile, "%12d %12d %12d %12d %12s", 
+                    server_size,
+                    key_size,
+                    value_size,
+                    thread_count,
+                    "TOTAL");
+                totalHist.printPercentiles(datFile, 1000.0, 1);
+                fprintf(datFile, " %12.0f %12lu %12.4f\n", 
+                    totalHist.getCount() / elapsed,
+                    totalHist.getCount(),
+                    PointSampler::getRelativeCIWidth(totalHist, samplingConfig));
+                fflush(datFile);
+                metrics.end({server_size, key_size, value_size, thread_count});
+                journal.markDone({server_size, key_size, value_size, thread_count});
+              } // th_idx
             } // vs_idx
           } // ks_idx
 
@@ -1198,6 +3165,108 @@ try
         } // sv_idx
 
         fclose(datFile);
+      } else if (op.compare("read_openloop") == 0 ||
+          op.compare("write_openloop") == 0) {
+        bool isWrite = (op.compare("write_openloop") == 0);
+
+        uint64_t tableId = client.createTable("test");
+        RequestArena arena(0, value_size_max);
+
+        // Open data file for writing.
+        FILE * datFile;
+        char filename[512];
+        if (isWrite)
+          sprintf(filename, "write_openloop.spp_%d.rf_%d.am_%s.mo_%d.ks_%d_%d_%d%s.vs_%d_%d_%d%s.or_%d_%d_%d%s.csv", samples_per_point, replicas, arrival_mode.c_str(), max_outstanding, key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), offered_rate_start, offered_rate_end, offered_rate_points, offered_rate_mode.c_str());
+        else
+          sprintf(filename, "read_openloop.spp_%d.am_%s.mo_%d.ks_%d_%d_%d%s.vs_%d_%d_%d%s.or_%d_%d_%d%s.csv", samples_per_point, arrival_mode.c_str(), max_outstanding, key_size_start, key_size_end, key_size_points, key_size_mode.c_str(), value_size_start, value_size_end, value_size_points, value_size_mode.c_str(), offered_rate_start, offered_rate_end, offered_rate_points, offered_rate_mode.c_str());
+        SweepJournal journal(filename, configHash, resume);
+        datFile = journal.openOutput();
+        PointMetrics metrics(&client, server_metrics, &journal,
+            {"KeySize", "ValueSize", "OfferedRate"});
+        fprintf(datFile, "%12s %12s %12s", 
+            "KeySize",
+            "ValueSize",
+            "OfferedRate");
+        LatencyHistogram::printHeader(datFile);
+        fprintf(datFile, " %12s %12s %12s\n", 
+            "AchievedRate",
+            "Late",
+            "Dropped");
+
+        OpenLoopGenerator::ArrivalMode arrivalMode = 
+            (arrival_mode.compare("fixed") == 0) ? 
+            OpenLoopGenerator::FIXED : OpenLoopGenerator::POISSON;
+
+        for (int ks_idx = 0; ks_idx < key_sizes.size(); ks_idx++) {
+          uint32_t key_size = key_sizes[ks_idx];
+
+          for (int vs_idx = 0; vs_idx < value_sizes.size(); vs_idx++) {
+            uint32_t value_size = value_sizes[vs_idx];
+
+            char randomKey[key_size];
+            memset(randomKey, 0, key_size);
+            const char* randomValue = arena.getValue();
+
+            client.write(tableId, randomKey, key_size, randomValue, value_size);
+
+            for (int or_idx = 0; or_idx < offered_rates.size(); or_idx++) {
+              uint32_t offered_rate = offered_rates[or_idx];
+
+              if (journal.isDone({key_size, value_size, offered_rate}))
+                continue;
+              metrics.begin();
+
+              printf("%s Open-Loop Test: key_size: %dB, value_size: %dB, offered_rate: %d/s\n", isWrite ? "Write" : "Read", key_size, value_size, offered_rate);
+
+              OpenLoopGenerator generator(&client, offered_rate, arrivalMode,
+                  max_outstanding, late_threshold_us * 1000UL);
+
+              LatencyHistogram latencyHist(histogram_precision);
+              OpenLoopGenerator::Result result;
+              if (isWrite) {
+                result = generator.run<WriteRpc>(samples_per_point,
+                    [&](Tub<WriteRpc>* slot, uint32_t slotIndex) {
+                      slot->construct(&client, tableId,
+                          (const char*)randomKey, key_size,
+                          randomValue, value_size);
+                    }, &latencyHist);
+              } else {
+                // Every outstanding read needs its own response buffer.
+                std::vector<Buffer> values(max_outstanding);
+                result = generator.run<ReadRpc>(samples_per_point,
+                    [&](Tub<ReadRpc>* slot, uint32_t slotIndex) {
+                      Buffer* value = &values[slotIndex];
+                      value->reset();
+                      slot->construct(&client, tableId,
+                          (const char*)randomKey, key_size, value);
+                    }, &latencyHist);
+              }
+
+              uint64_t samples = latencyHist.getCount();
+              if (samples == 0) {
+                printf("WARNING: No requests completed at offered_rate=%d. Skipping this parameter configuration.\n", offered_rate);
+                continue;
+              }
+
+              fprintf(datFile, "%12d %12d %12d", 
+                  key_size,
+                  value_size,
+                  offered_rate);
+              latencyHist.printPercentiles(datFile, 1000.0, 1);
+              fprintf(datFile, " %12.0f %12lu %12lu\n", 
+                  result.achievedRate,
+                  result.late,
+                  result.dropped);
+              fflush(datFile);
+              metrics.end({key_size, value_size, offered_rate});
+              journal.markDone({key_size, value_size, offered_rate});
+            } // or_idx
+          } // vs_idx
+        } // ks_idx
+
+        fclose(datFile);
+
+        client.dropTable("test");
       } else {
         printf("ERROR: Unknown operation: %s\n", op.c_str());
         return 1;
@@ -0,0 +1,221 @@
+/* Copyright (c) 2009-2015 Stanford University
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR(S) DISCLAIM ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL AUTHORS BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "LatencyHistogram.h"
+#include "TraceWriter.h"
+
+/* Reads the binary sample traces written by rcperf --trace and recomputes
+ * statistics from the raw samples.
+ *
+ * Usage: rctrace [options] <trace file>
+ *
+ * By default prints one row per (point, op type) with the sample count, the
+ * standard percentiles and the maximum in microseconds, and the point's
+ * description from <trace file>.points (its CSV file and parameter values).
+ *
+ * Options:
+ *   --point N: Only use samples of point N.
+ *   --op N: Only use samples of op type N.
+ *   --from S, --to S: Only use samples recorded between S and S seconds after
+ *       the first sample in the trace.
+ *   --slice S: Split every point into slices of S seconds and print a row
+ *       per slice, to see how latency changes over the course of a point.
+ *   --dump: Print every sample (time in seconds, point, op type, latency in
+ *       microseconds) instead of statistics.
+ *   --precision N: Significant digits kept by the histograms (default 3).
+ */
+
+static void
+usage()
+{
+    fprintf(stderr, "Usage: rctrace [--point N] [--op N] [--from S] [--to S] "
+        "[--slice S] [--dump] [--precision N] <trace file>\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+    int64_t point = -1;
+    int64_t opType = -1;
+    double from = 0;
+    double to = -1;
+    double slice = 0;
+    bool dump = false;
+    int precision = 3;
+
+    static struct option longOptions[] = {
+        {"point", required_argument, NULL, 'p'},
+        {"op", required_argument, NULL, 'o'},
+        {"from", required_argument, NULL, 'f'},
+        {"to", required_argument, NULL, 't'},
+        {"slice", required_argument, NULL, 's'},
+        {"dump", no_argument, NULL, 'd'},
+        {"precision", required_argument, NULL, 'r'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "", longOptions, NULL)) != -1) {
+        switch (c) {
+            case 'p': point = atoll(optarg); break;
+            case 'o': opType = atoll(optarg); break;
+            case 'f': from = atof(optarg); break;
+            case 't': to = atof(optarg); break;
+            case 's': slice = atof(optarg); break;
+            case 'd': dump = true; break;
+            case 'r': precision = atoi(optarg); break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+    if (optind != argc - 1) {
+        usage();
+        return 1;
+    }
+    const char* traceFilename = argv[optind];
+
+    // Map the trace.
+    int fd = open(traceFilename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "ERROR: Could not open %s\n", traceFilename);
+        return 1;
+    }
+    size_t size = st.st_size;
+    if (size < sizeof(TraceFileHeader)) {
+        fprintf(stderr, "ERROR: %s is too short to be a trace\n",
+            traceFilename);
+        return 1;
+    }
+    void* addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        fprintf(stderr, "ERROR: Could not map %s\n", traceFilename);
+        return 1;
+    }
+
+    const TraceFileHeader* header = static_cast<const TraceFileHeader*>(addr);
+    if (memcmp(header->magic, TRACE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != TRACE_VERSION ||
+        header->recordSize != sizeof(TraceRecord)) {
+        fprintf(stderr, "ERROR: %s is not a version %d trace\n",
+            traceFilename, TRACE_VERSION);
+        return 1;
+    }
+    const TraceRecord* records = reinterpret_cast<const TraceRecord*>(
+        static_cast<const char*>(addr) + sizeof(TraceFileHeader));
+    uint64_t count = (size - sizeof(TraceFileHeader)) / sizeof(TraceRecord);
+
+    // Point descriptions, indexed by point id.
+    std::vector<std::string> points;
+    std::ifstream pointsFile(std::string(traceFilename) + ".points");
+    std::string line;
+    while (std::getline(pointsFile, line)) {
+        size_t space = line.find(' ');
+        uint32_t id = atoi(line.substr(0, space).c_str());
+        if (id >= points.size())
+            points.resize(id + 1);
+        if (space != std::string::npos)
+            points[id] = line.substr(space + 1);
+    }
+
+    // Records from different threads are not in time order.
+    uint64_t firstTimestamp = ~0UL;
+    for (uint64_t i = 0; i < count; i++)
+        firstTimestamp = std::min(firstTimestamp, records[i].timestamp);
+
+    if (dump) {
+        printf("%12s %12s %12s %12s\n",
+            "Time",
+            "PointId",
+            "Op",
+            "Latency");
+    }
+
+    // Histograms by (point, op type, slice).
+    typedef std::tuple<uint32_t, uint32_t, uint64_t> Key;
+    std::map<Key, LatencyHistogram> hists;
+    for (uint64_t i = 0; i < count; i++) {
+        const TraceRecord& record = records[i];
+        double time = (record.timestamp - firstTimestamp) /
+            header->cyclesPerSecond;
+        if ((point >= 0 && record.pointId != point) ||
+            (opType >= 0 && record.opType != opType) ||
+            time < from || (to >= 0 && time > to))
+            continue;
+
+        if (dump) {
+            printf("%12.6f %12u %12u %12.3f\n",
+                time,
+                record.pointId,
+                record.opType,
+                record.latencyNs / 1000.0);
+            continue;
+        }
+
+        uint64_t sliceIndex = (slice > 0) ? (uint64_t)(time / slice) : 0;
+        Key key(record.pointId, record.opType, sliceIndex);
+        std::map<Key, LatencyHistogram>::iterator it = hists.find(key);
+        if (it == hists.end()) {
+            it = hists.insert(std::make_pair(key,
+                LatencyHistogram(precision))).first;
+        }
+        it->second.record(record.latencyNs);
+    }
+
+    if (dump)
+        return 0;
+
+    printf("%12s %12s",
+        "PointId",
+        "Op");
+    if (slice > 0)
+        printf(" %12s", "SliceStart");
+    printf(" %12s", "Count");
+    LatencyHistogram::printHeader(stdout);
+    printf(" %s\n", "Point");
+
+    for (std::map<Key, LatencyHistogram>::iterator it = hists.begin();
+            it != hists.end(); it++) {
+        uint32_t pointId = std::get<0>(it->first);
+        printf("%12u %12u",
+            pointId,
+            std::get<1>(it->first));
+        if (slice > 0)
+            printf(" %12.3f", std::get<2>(it->first) * slice);
+        printf(" %12lu", it->second.getCount());
+        it->second.printPercentiles(stdout, 1000.0, 1);
+        printf(" %s\n",
+            (pointId < points.size()) ? points[pointId].c_str() : "");
+    }
+
+    return 0;
+}